@@ -0,0 +1,274 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file bench.c
+ *
+ * Host micro-benchmarks of the hot paths of truck_component, against stubbed Legato services (stubs.c) :
+ *      emulate(), Accumulate() with a good and a poor radio, pushData(), OnWriteSetting(), a bouncing door switch and the gpio_iot wrappers
+ *      For each operation : time per call (ns/op), allocations, service calls (IPC on target) and log messages per call
+ *
+ *  fridgeTruck.c is included so that its static functions can be called, the helper libs are linked as they are.
+ *  The pushes issued by an operation are acknowledged right after it, within the measure : the callbacks are part of the cost.
+ *
+ *    Usage : fridgeTruckBench [iterations]
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "fridgeTruck.c"
+
+#include "bench.h"
+
+#define BENCH_DEFAULT_ITERATIONS			100000
+#define BENCH_WARMUP_ITERATIONS				1000
+
+//edges of a push on a bouncing door contact
+#define BENCH_BOUNCE_EDGES					8
+
+typedef struct
+{
+	const char*		namePtr;
+	void			(*setupPtr)();			//optional, before the warmup
+	void			(*runPtr)(uint64_t iteration);
+	void			(*teardownPtr)();		//optional, after the measure
+} Bench_t;
+
+static const Resource_t*					_benchSettingPtr = NULL;
+static int									_benchDataGenInterval = 0;
+static gpio_iot_PinRef_t					_benchFanPin = NULL;
+
+
+//nanoseconds of the monotonic clock
+static uint64_t GetNs()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+//Operations
+static void RunEmulate(uint64_t iteration)
+{
+	emulate(NULL);
+}
+
+static void SetupRaw()
+{
+	_aggregateRaw = true;
+}
+
+static void TeardownRaw()
+{
+	_aggregateRaw = false;
+}
+
+static void SetupZones()
+{
+	_zoneCount = ZONE_MAX_COUNT;
+	CreateZoneResources();
+}
+
+static void TeardownZones()
+{
+	_zoneCount = 1;
+}
+
+static void RunAccumulate(uint64_t iteration)
+{
+	Accumulate();
+}
+
+//the signal is below the min quality : the timeseries are held instead of pushed
+static void SetupPoorRadio()
+{
+	bench_SetSignalQuality(0);
+	uplink_SetMinQuality(_uplinkMinQuality);
+}
+
+static void TeardownPoorRadio()
+{
+	bench_SetSignalQuality(5);
+	uplink_SetMinQuality(_uplinkMinQuality);
+}
+
+static void RunPushData(uint64_t iteration)
+{
+	pushData(NULL);
+}
+
+//the data generation interval alternates between 2 values, so that every write is a change
+static void SetupWriteSetting()
+{
+	size_t i;
+
+	for (i = 0; (i < GetResourceCount()) && (NULL == _benchSettingPtr); i++)
+	{
+		if (0 == strcmp(GetResource(i)->pathPtr, SETTING_DATAGEN_INTERVAL))
+		{
+			_benchSettingPtr = GetResource(i);
+		}
+	}
+
+	LE_ASSERT(_benchSettingPtr);
+	_benchDataGenInterval = _dataGenInterval;
+}
+
+static void RunWriteSetting(uint64_t iteration)
+{
+	bench_SetServerValue(_benchDataGenInterval + 1 - (iteration & 1), 0, false);
+	OnWriteSetting(SETTING_DATAGEN_INTERVAL, LE_AVDATA_ACCESS_WRITE, NULL, (void*)_benchSettingPtr);
+}
+
+static void TeardownWriteSetting()
+{
+	bench_SetServerValue(_benchDataGenInterval, 0, false);
+	OnWriteSetting(SETTING_DATAGEN_INTERVAL, LE_AVDATA_ACCESS_WRITE, NULL, (void*)_benchSettingPtr);
+}
+
+//one push of the door switch : the contact bounces on press and on release, then settles
+static void RunDoorBounce(uint64_t iteration)
+{
+	int i;
+
+	for (i = 0; i < BENCH_BOUNCE_EDGES; i++)
+	{
+		bench_SetInputs(0 == (i & 1));
+	}
+
+	bench_ExpireTimers("gpioDebounce");
+
+	for (i = 0; i < BENCH_BOUNCE_EDGES; i++)
+	{
+		bench_SetInputs(1 == (i & 1));
+	}
+
+	bench_ExpireTimers("gpioDebounce");
+}
+
+//the same push without debouncing : every rising edge of the burst is a toggle of the door
+static void RunDoorBounceRaw(uint64_t iteration)
+{
+	int i;
+
+	for (i = 0; i < BENCH_BOUNCE_EDGES; i++)
+	{
+		OnDoorSwitchChangeCallback(true, NULL);
+	}
+}
+
+static void SetupPin()
+{
+	_benchFanPin = gpio_iot_GetPin(GPIO_PIN_FAN_MOTOR);
+}
+
+static void RunPinSetOutput(uint64_t iteration)
+{
+	gpio_iot_PinSetOutput(_benchFanPin, iteration & 1);
+}
+
+static void RunPinRead(uint64_t iteration)
+{
+	gpio_iot_PinRead(_benchFanPin);
+}
+
+static void RunSetOutput(uint64_t iteration)
+{
+	gpio_iot_SetOutput(GPIO_PIN_FAN_MOTOR, iteration & 1);
+}
+
+static void RunRead(uint64_t iteration)
+{
+	gpio_iot_Read(GPIO_PIN_DOOR_SWITCH);
+}
+
+static void RunSetOutputs(uint64_t iteration)
+{
+	gpio_iot_SetOutputs(GPIO_ACTUATORS_MASK, (iteration & 1) ? GPIO_ACTUATORS_MASK : 0);
+}
+
+static const Bench_t						_benches[] =
+{
+	{ "emulate",						NULL,				RunEmulate,			NULL },
+	{ "emulate (raw)",					SetupRaw,			RunEmulate,			TeardownRaw },
+	{ "emulate (4 zones)",				SetupZones,			RunEmulate,			TeardownZones },
+	{ "Accumulate",						NULL,				RunAccumulate,		NULL },
+	{ "Accumulate (poor radio)",		SetupPoorRadio,		RunAccumulate,		TeardownPoorRadio },
+	{ "pushData",						NULL,				RunPushData,		NULL },
+	{ "OnWriteSetting",					SetupWriteSetting,	RunWriteSetting,	TeardownWriteSetting },
+	{ "door switch (debounced)",		NULL,				RunDoorBounce,		NULL },
+	{ "door switch (raw)",				NULL,				RunDoorBounceRaw,	NULL },
+	{ "gpio_iot_PinSetOutput",			SetupPin,			RunPinSetOutput,	NULL },
+	{ "gpio_iot_PinRead",				SetupPin,			RunPinRead,			NULL },
+	{ "gpio_iot_SetOutput",				NULL,				RunSetOutput,		NULL },
+	{ "gpio_iot_Read",					NULL,				RunRead,			NULL },
+	{ "gpio_iot_SetOutputs",			NULL,				RunSetOutputs,		NULL },
+};
+
+//run an operation, and print what it costs per call
+static void RunBench(const Bench_t* benchPtr, uint64_t iterations)
+{
+	bench_Counters_t	start;
+	uint64_t			startNs;
+	uint64_t			elapsedNs;
+	uint64_t			i;
+
+	if (benchPtr->setupPtr)
+	{
+		benchPtr->setupPtr();
+	}
+
+	for (i = 0; i < BENCH_WARMUP_ITERATIONS; i++)
+	{
+		benchPtr->runPtr(i);
+		bench_CompletePushes();
+	}
+
+	start = bench_Counters;
+	startNs = GetNs();
+
+	for (i = 0; i < iterations; i++)
+	{
+		benchPtr->runPtr(i);
+		bench_CompletePushes();
+	}
+
+	elapsedNs = GetNs() - startNs;
+
+	printf("%-28s %10.1f %10.3f %10.3f %10.3f\n", benchPtr->namePtr,
+		   (double)elapsedNs / iterations,
+		   (double)(bench_Counters.allocs - start.allocs) / iterations,
+		   (double)(bench_Counters.ipc - start.ipc) / iterations,
+		   (double)(bench_Counters.logs - start.logs) / iterations);
+
+	if (benchPtr->teardownPtr)
+	{
+		benchPtr->teardownPtr();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint64_t	iterations = (argc > 1) ? strtoull(argv[1], NULL, 10) : BENCH_DEFAULT_ITERATIONS;
+	size_t		i;
+
+	if (0 == iterations)
+	{
+		fprintf(stderr, "Usage : %s [iterations]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	//the app as started on target, with the session up
+	bench_ComponentInit();
+	bench_StartSession();
+	bench_CompletePushes();
+
+	printf("%" PRIu64 " iterations\n", iterations);
+	printf("%-28s %10s %10s %10s %10s\n", "operation", "ns/op", "allocs/op", "ipc/op", "logs/op");
+
+	for (i = 0; i < NUM_ARRAY_MEMBERS(_benches); i++)
+	{
+		RunBench(&_benches[i], iterations);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,43 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file bench.h
+ *
+ * Counters and controls of the stubbed Legato services, for the host micro-benchmarks (see bench.c)
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+//what an operation costs besides its duration
+typedef struct
+{
+	uint64_t		ipc;			//calls to a service (le_avdata, le_pos, le_posCtrl, le_mrc, le_gpioPinN, le_cfg)
+	uint64_t		allocs;			//malloc/calloc/realloc of the component, blocks taken from le_mem pools, timers created
+	uint64_t		logs;			//log messages
+} bench_Counters_t;
+
+extern bench_Counters_t		bench_Counters;
+
+//Start the AirVantage session, through the handler registered by the component
+void bench_StartSession();
+
+//Stop the AirVantage session, the callbacks of the pushes issued so far can still be called by bench_CompletePushes()
+void bench_StopSession();
+
+//Call the callbacks of the pushes issued so far, as if AirVantage acknowledged them, returns the number of callbacks
+size_t bench_CompletePushes();
+
+//Value read by the component in le_avdata_GetInt / GetFloat / GetBool, as if written by AirVantage
+void bench_SetServerValue(int32_t intValue, double floatValue, bool boolValue);
+
+//Signal quality answered by le_mrc_GetSignalQual (0 to 5), 5 at start
+void bench_SetSignalQuality(uint32_t quality);
+
+//Call the handlers of the running timers created with the given name, as if they expired, returns the number of timers
+size_t bench_ExpireTimers(const char* nameStr);
+
+//Drive every input pin to the given level, its change handler is called on an edge matching its trigger
+void bench_SetInputs(bool level);
+
+#endif //_BENCH_H_
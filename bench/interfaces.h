@@ -0,0 +1,188 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file interfaces.h
+ *
+ * Stub of the services bound to truck_component (le_avdata, le_pos, le_posCtrl, le_mrc, le_gpioPinN, le_cfg)
+ * for the host micro-benchmarks (see bench.c) :
+ *      Every call to a service function is counted as an IPC, as it is a message to another process on target
+ *      The stubs are implemented in stubs.c
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _BENCH_INTERFACES_H_
+#define _BENCH_INTERFACES_H_
+
+#include "legato.h"
+
+//le_avdata
+typedef enum
+{
+	LE_AVDATA_ACCESS_VARIABLE = 0x1,
+	LE_AVDATA_ACCESS_SETTING = 0x2,
+	LE_AVDATA_ACCESS_COMMAND = 0x4
+} le_avdata_AccessMode_t;
+
+typedef enum
+{
+	LE_AVDATA_ACCESS_READ = 0x1,
+	LE_AVDATA_ACCESS_WRITE = 0x2,
+	LE_AVDATA_ACCESS_EXEC = 0x4
+} le_avdata_AccessType_t;
+
+typedef enum
+{
+	LE_AVDATA_NAMESPACE_APPLICATION = 0,
+	LE_AVDATA_NAMESPACE_GLOBAL = 1
+} le_avdata_Namespace_t;
+
+typedef enum
+{
+	LE_AVDATA_PUSH_SUCCESS = 0,
+	LE_AVDATA_PUSH_FAILED = 1
+} le_avdata_PushStatus_t;
+
+typedef enum
+{
+	LE_AVDATA_SESSION_STARTED = 0,
+	LE_AVDATA_SESSION_STOPPED = 1
+} le_avdata_SessionState_t;
+
+typedef struct le_avdata_Record* le_avdata_RecordRef_t;
+typedef struct le_avdata_ArgumentList* le_avdata_ArgumentListRef_t;
+typedef struct le_avdata_RequestSessionObj* le_avdata_RequestSessionObjRef_t;
+typedef struct le_avdata_ResourceEventHandler* le_avdata_ResourceEventHandlerRef_t;
+typedef struct le_avdata_SessionStateHandler* le_avdata_SessionStateHandlerRef_t;
+
+typedef void (*le_avdata_ResourceHandlerFunc_t)(const char* path, le_avdata_AccessType_t accessType, le_avdata_ArgumentListRef_t argumentListRef, void* contextPtr);
+typedef void (*le_avdata_CallbackFunc_t)(le_avdata_PushStatus_t status, void* contextPtr);
+typedef void (*le_avdata_SessionStateHandlerFunc_t)(le_avdata_SessionState_t sessionState, void* contextPtr);
+
+le_result_t							le_avdata_CreateResource(const char* path, le_avdata_AccessMode_t accessMode);
+le_result_t							le_avdata_SetNamespace(le_avdata_Namespace_t namespace);
+le_result_t							le_avdata_SetInt(const char* path, int32_t value);
+le_result_t							le_avdata_GetInt(const char* path, int32_t* valuePtr);
+le_result_t							le_avdata_SetFloat(const char* path, double value);
+le_result_t							le_avdata_GetFloat(const char* path, double* valuePtr);
+le_result_t							le_avdata_SetBool(const char* path, bool value);
+le_result_t							le_avdata_GetBool(const char* path, bool* valuePtr);
+le_avdata_ResourceEventHandlerRef_t	le_avdata_AddResourceEventHandler(const char* path, le_avdata_ResourceHandlerFunc_t handlerPtr, void* contextPtr);
+void								le_avdata_ReplyExecResult(le_avdata_ArgumentListRef_t argumentListRef, le_result_t result);
+le_result_t							le_avdata_Push(const char* path, le_avdata_CallbackFunc_t handlerPtr, void* contextPtr);
+le_avdata_RecordRef_t				le_avdata_CreateRecord(void);
+void								le_avdata_DeleteRecord(le_avdata_RecordRef_t recordRef);
+le_result_t							le_avdata_RecordInt(le_avdata_RecordRef_t recordRef, const char* path, int32_t value, uint64_t timestamp);
+le_result_t							le_avdata_RecordFloat(le_avdata_RecordRef_t recordRef, const char* path, double value, uint64_t timestamp);
+le_result_t							le_avdata_RecordBool(le_avdata_RecordRef_t recordRef, const char* path, bool value, uint64_t timestamp);
+le_result_t							le_avdata_PushRecord(le_avdata_RecordRef_t recordRef, le_avdata_CallbackFunc_t handlerPtr, void* contextPtr);
+le_avdata_RequestSessionObjRef_t	le_avdata_RequestSession(void);
+void								le_avdata_ReleaseSession(le_avdata_RequestSessionObjRef_t sessionRequestRef);
+le_avdata_SessionStateHandlerRef_t	le_avdata_AddSessionStateHandler(le_avdata_SessionStateHandlerFunc_t handlerPtr, void* contextPtr);
+
+//le_pos, le_posCtrl
+typedef enum
+{
+	LE_POS_STATE_NO_FIX = 0,
+	LE_POS_STATE_FIX_2D = 1,
+	LE_POS_STATE_FIX_3D = 2,
+	LE_POS_STATE_FIX_ESTIMATED = 3,
+	LE_POS_STATE_UNKNOWN = 4
+} le_pos_FixState_t;
+
+typedef struct le_pos_Sample* le_pos_SampleRef_t;
+typedef struct le_pos_MovementHandler* le_pos_MovementHandlerRef_t;
+typedef struct le_posCtrl_Activation* le_posCtrl_ActivationRef_t;
+
+typedef void (*le_pos_MovementHandlerFunc_t)(le_pos_SampleRef_t positionSampleRef, void* contextPtr);
+
+le_result_t							le_pos_GetFixState(le_pos_FixState_t* statePtr);
+le_result_t							le_pos_Get2DLocation(int32_t* latitudePtr, int32_t* longitudePtr, int32_t* hAccuracyPtr);
+le_result_t							le_pos_Get3DLocation(int32_t* latitudePtr, int32_t* longitudePtr, int32_t* hAccuracyPtr, int32_t* altitudePtr, int32_t* vAccuracyPtr);
+le_pos_MovementHandlerRef_t			le_pos_AddMovementHandler(uint32_t horizontalMagnitude, uint32_t verticalMagnitude, le_pos_MovementHandlerFunc_t handlerPtr, void* contextPtr);
+void								le_pos_RemoveMovementHandler(le_pos_MovementHandlerRef_t handlerRef);
+le_result_t							le_pos_sample_GetFixState(le_pos_SampleRef_t positionSampleRef, le_pos_FixState_t* statePtr);
+le_result_t							le_pos_sample_Get2DLocation(le_pos_SampleRef_t positionSampleRef, int32_t* latitudePtr, int32_t* longitudePtr, int32_t* hAccuracyPtr);
+le_result_t							le_pos_sample_GetAltitude(le_pos_SampleRef_t positionSampleRef, int32_t* altitudePtr, int32_t* vAccuracyPtr);
+void								le_pos_sample_Release(le_pos_SampleRef_t positionSampleRef);
+void								le_pos_ConnectService(void);
+le_posCtrl_ActivationRef_t			le_posCtrl_Request(void);
+void								le_posCtrl_Release(le_posCtrl_ActivationRef_t ref);
+
+//le_mrc : an LTE network, the signal quality is set by the bench
+typedef enum
+{
+	LE_MRC_RAT_UNKNOWN = 0,
+	LE_MRC_RAT_GSM = 1,
+	LE_MRC_RAT_UMTS = 2,
+	LE_MRC_RAT_TDSCDMA = 3,
+	LE_MRC_RAT_LTE = 4,
+	LE_MRC_RAT_CDMA = 5
+} le_mrc_Rat_t;
+
+le_result_t							le_mrc_GetSignalQual(uint32_t* qualityPtr);
+le_result_t							le_mrc_GetRadioAccessTechInUse(le_mrc_Rat_t* ratPtr);
+
+//le_cfg : an empty tree, reads return the defaults
+typedef struct le_cfg_Iterator* le_cfg_IteratorRef_t;
+
+void								le_cfg_ConnectService(void);
+le_cfg_IteratorRef_t				le_cfg_CreateReadTxn(const char* basePath);
+le_cfg_IteratorRef_t				le_cfg_CreateWriteTxn(const char* basePath);
+void								le_cfg_CommitTxn(le_cfg_IteratorRef_t iteratorRef);
+void								le_cfg_CancelTxn(le_cfg_IteratorRef_t iteratorRef);
+bool								le_cfg_NodeExists(le_cfg_IteratorRef_t iteratorRef, const char* path);
+int32_t								le_cfg_GetInt(le_cfg_IteratorRef_t iteratorRef, const char* path, int32_t defaultValue);
+void								le_cfg_SetInt(le_cfg_IteratorRef_t iteratorRef, const char* path, int32_t value);
+double								le_cfg_GetFloat(le_cfg_IteratorRef_t iteratorRef, const char* path, double defaultValue);
+void								le_cfg_SetFloat(le_cfg_IteratorRef_t iteratorRef, const char* path, double value);
+bool								le_cfg_GetBool(le_cfg_IteratorRef_t iteratorRef, const char* path, bool defaultValue);
+void								le_cfg_SetBool(le_cfg_IteratorRef_t iteratorRef, const char* path, bool value);
+void								le_cfg_DeleteNode(le_cfg_IteratorRef_t iteratorRef, const char* path);
+int32_t								le_cfg_QuickGetInt(const char* path, int32_t defaultValue);
+void								le_cfg_QuickSetInt(const char* path, int32_t value);
+
+//le_gpioPinN, one interface per CF3 pin wired to the IoT card
+typedef enum
+{
+	LE_GPIO_ACTIVE_HIGH = 0,
+	LE_GPIO_ACTIVE_LOW = 1
+} le_gpio_Polarity_t;
+
+typedef enum
+{
+	LE_GPIO_EDGE_NONE = 0,
+	LE_GPIO_EDGE_RISING = 1,
+	LE_GPIO_EDGE_FALLING = 2,
+	LE_GPIO_EDGE_BOTH = 3
+} le_gpio_Edge_t;
+
+typedef enum
+{
+	LE_GPIO_PULL_OFF = 0,
+	LE_GPIO_PULL_DOWN = 1,
+	LE_GPIO_PULL_UP = 2
+} le_gpio_PullUpDown_t;
+
+#define BENCH_GPIO_PIN_API(N)																												\
+	typedef struct le_gpioPin##N##_ChangeEventHandler* le_gpioPin##N##_ChangeEventHandlerRef_t;											\
+	typedef void (*le_gpioPin##N##_ChangeCallbackFunc_t)(bool state, void* contextPtr);													\
+	le_result_t								le_gpioPin##N##_SetInput(le_gpio_Polarity_t polarity);										\
+	le_result_t								le_gpioPin##N##_SetPushPullOutput(le_gpio_Polarity_t polarity, bool value);					\
+	le_result_t								le_gpioPin##N##_Activate(void);																\
+	le_result_t								le_gpioPin##N##_Deactivate(void);															\
+	bool									le_gpioPin##N##_Read(void);																	\
+	bool									le_gpioPin##N##_IsInput(void);																\
+	le_gpio_Polarity_t						le_gpioPin##N##_GetPolarity(void);															\
+	le_gpio_PullUpDown_t					le_gpioPin##N##_GetPullUpDown(void);														\
+	le_result_t								le_gpioPin##N##_EnablePullUp(void);															\
+	le_result_t								le_gpioPin##N##_EnablePullDown(void);														\
+	le_gpio_Edge_t							le_gpioPin##N##_GetEdgeSense(void);															\
+	le_gpioPin##N##_ChangeEventHandlerRef_t	le_gpioPin##N##_AddChangeEventHandler(le_gpio_Edge_t trigger,								\
+												le_gpioPin##N##_ChangeCallbackFunc_t handlerPtr, void* contextPtr, int32_t sampleMs);
+
+BENCH_GPIO_PIN_API(7)
+BENCH_GPIO_PIN_API(8)
+BENCH_GPIO_PIN_API(13)
+BENCH_GPIO_PIN_API(33)
+BENCH_GPIO_PIN_API(42)
+
+#endif //_BENCH_INTERFACES_H_
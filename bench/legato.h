@@ -0,0 +1,146 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file legato.h
+ *
+ * Stub of the Legato framework for the host micro-benchmarks of truck_component (see bench.c):
+ *      Only what the component uses is declared, implemented in stubs.c
+ *      No thread is started : the jobs of the worker helper lib run on the calling thread, as they are measured
+ *      Log messages are formatted, as with LE_LOG_LEVEL=DEBUG on target, and counted
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _BENCH_LEGATO_H_
+#define _BENCH_LEGATO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+typedef enum
+{
+	LE_OK = 0,
+	LE_NOT_FOUND = -1,
+	LE_NOT_POSSIBLE = -2,
+	LE_OUT_OF_RANGE = -3,
+	LE_NO_MEMORY = -4,
+	LE_NOT_PERMITTED = -5,
+	LE_FAULT = -6,
+	LE_COMM_ERROR = -7,
+	LE_TIMEOUT = -8,
+	LE_OVERFLOW = -9,
+	LE_UNDERFLOW = -10,
+	LE_WOULD_BLOCK = -11,
+	LE_DEADLOCK = -12,
+	LE_FORMAT_ERROR = -13,
+	LE_DUPLICATE = -14,
+	LE_BAD_PARAMETER = -15,
+	LE_CLOSED = -16,
+	LE_BUSY = -17,
+	LE_UNSUPPORTED = -18,
+	LE_IO_ERROR = -19,
+	LE_NOT_IMPLEMENTED = -20,
+	LE_UNAVAILABLE = -21,
+	LE_TERMINATED = -22
+} le_result_t;
+
+//Logging
+void bench_Log(const char* formatPtr, ...) __attribute__((format(printf, 1, 2)));
+
+#define LE_DEBUG(...)						bench_Log(__VA_ARGS__)
+#define LE_INFO(...)						bench_Log(__VA_ARGS__)
+#define LE_WARN(...)						bench_Log(__VA_ARGS__)
+#define LE_ERROR(...)						bench_Log(__VA_ARGS__)
+#define LE_CRIT(...)						bench_Log(__VA_ARGS__)
+#define LE_FATAL(...)						do { bench_Log(__VA_ARGS__); abort(); } while (0)
+#define LE_ASSERT(condition)				do { if (!(condition)) { abort(); } } while (0)
+#define LE_ERROR_IF(condition, ...)			do { if (condition) { bench_Log(__VA_ARGS__); } } while (0)
+#define LE_WARN_IF(condition, ...)			do { if (condition) { bench_Log(__VA_ARGS__); } } while (0)
+#define LE_FATAL_IF(condition, ...)			do { if (condition) { bench_Log(__VA_ARGS__); abort(); } } while (0)
+#define LE_RESULT_TXT(result)				"le_result"
+
+#define NUM_ARRAY_MEMBERS(array)			(sizeof(array) / sizeof((array)[0]))
+
+//the component init is called by the bench
+#define COMPONENT_INIT						void bench_ComponentInit(void)
+
+//Clock
+typedef struct
+{
+	time_t	sec;
+	long	usec;
+} le_clk_Time_t;
+
+le_clk_Time_t	le_clk_GetRelativeTime(void);
+le_clk_Time_t	le_clk_GetAbsoluteTime(void);
+le_clk_Time_t	le_clk_Add(le_clk_Time_t timeA, le_clk_Time_t timeB);
+le_clk_Time_t	le_clk_Sub(le_clk_Time_t timeA, le_clk_Time_t timeB);
+bool			le_clk_GreaterThan(le_clk_Time_t timeA, le_clk_Time_t timeB);
+
+//Timers : never expire, the bench calls the handlers
+typedef struct le_timer* le_timer_Ref_t;
+typedef void (*le_timer_ExpiryHandler_t)(le_timer_Ref_t timerRef);
+
+le_timer_Ref_t	le_timer_Create(const char* nameStr);
+void			le_timer_Delete(le_timer_Ref_t timerRef);
+le_result_t		le_timer_SetHandler(le_timer_Ref_t timerRef, le_timer_ExpiryHandler_t handlerRef);
+le_result_t		le_timer_SetInterval(le_timer_Ref_t timerRef, le_clk_Time_t interval);
+le_result_t		le_timer_SetMsInterval(le_timer_Ref_t timerRef, uint32_t interval);
+uint32_t		le_timer_GetMsInterval(le_timer_Ref_t timerRef);
+le_result_t		le_timer_SetRepeat(le_timer_Ref_t timerRef, uint32_t repeatCount);
+le_result_t		le_timer_SetContextPtr(le_timer_Ref_t timerRef, void* contextPtr);
+void*			le_timer_GetContextPtr(le_timer_Ref_t timerRef);
+le_result_t		le_timer_Start(le_timer_Ref_t timerRef);
+le_result_t		le_timer_Stop(le_timer_Ref_t timerRef);
+le_result_t		le_timer_Restart(le_timer_Ref_t timerRef);
+bool			le_timer_IsRunning(le_timer_Ref_t timerRef);
+
+//Signals
+typedef void (*le_sig_EventHandlerFunc_t)(int sigNum);
+
+void			le_sig_Block(int sigNum);
+void			le_sig_SetEventHandler(int sigNum, le_sig_EventHandlerFunc_t sigEventHandler);
+
+//Threads : never started, le_thread_Create answers NULL
+typedef struct le_thread* le_thread_Ref_t;
+typedef void* (*le_thread_MainFunc_t)(void* contextPtr);
+
+le_thread_Ref_t	le_thread_Create(const char* name, le_thread_MainFunc_t mainFunc, void* contextPtr);
+void			le_thread_Start(le_thread_Ref_t threadRef);
+le_thread_Ref_t	le_thread_GetCurrent(void);
+
+//Semaphores
+typedef struct le_sem* le_sem_Ref_t;
+
+le_sem_Ref_t	le_sem_Create(const char* name, int32_t initialCount);
+void			le_sem_Post(le_sem_Ref_t semaphorePtr);
+void			le_sem_Wait(le_sem_Ref_t semaphorePtr);
+le_result_t		le_sem_WaitWithTimeout(le_sem_Ref_t semaphorePtr, le_clk_Time_t timeToWait);
+
+//Deferred functions : called right away
+typedef void (*le_event_DeferredFunc_t)(void* param1Ptr, void* param2Ptr);
+
+void			le_event_QueueFunction(le_event_DeferredFunc_t func, void* param1Ptr, void* param2Ptr);
+void			le_event_QueueFunctionToThread(le_thread_Ref_t thread, le_event_DeferredFunc_t func, void* param1Ptr, void* param2Ptr);
+
+//Memory pools : every block taken from a pool is counted as an allocation
+typedef struct le_mem_Pool* le_mem_PoolRef_t;
+
+le_mem_PoolRef_t	le_mem_CreatePool(const char* name, size_t objSize);
+le_mem_PoolRef_t	le_mem_ExpandPool(le_mem_PoolRef_t pool, size_t numObjects);
+void*				le_mem_ForceAlloc(le_mem_PoolRef_t pool);
+void*				le_mem_TryAlloc(le_mem_PoolRef_t pool);
+void				le_mem_Release(void* objPtr);
+
+#endif //_BENCH_LEGATO_H_
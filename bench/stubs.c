@@ -0,0 +1,797 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file stubs.c
+ *
+ * Stubs of the Legato framework and of the services bound to truck_component, for the host micro-benchmarks :
+ *      le_avdata keeps the records and the push callbacks, pushes are acknowledged by bench_CompletePushes()
+ *      le_cfg is an empty tree, le_pos always has a 3D fix, le_gpioPinN keeps the pin state
+ *      Service calls, allocations and log messages are counted in bench_Counters
+ *
+ *  The allocations of the component are counted by wrapping malloc/calloc/realloc at link time (--wrap),
+ *  the stubs themselves use static storage or the real allocator so that they are not counted.
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include <stdarg.h>
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "bench.h"
+
+//max number of records alive in avcService
+#define BENCH_MAX_RECORDS					16
+
+//max number of samples in a record, avcService reports LE_NO_MEMORY beyond
+#define BENCH_RECORD_MAX_SAMPLES			512
+
+//max number of pushes waiting for their callback
+#define BENCH_MAX_PENDING_PUSHES			64
+
+//max number of timers
+#define BENCH_MAX_TIMERS					32
+
+struct le_avdata_Record
+{
+	bool						used;
+	size_t						sampleCount;
+};
+
+struct le_timer
+{
+	const char*					namePtr;
+	le_timer_ExpiryHandler_t	handlerPtr;
+	void*						contextPtr;
+	uint32_t					intervalMs;
+	bool						running;
+};
+
+struct le_mem_Pool
+{
+	size_t						objSize;
+};
+
+typedef struct
+{
+	le_avdata_CallbackFunc_t	handlerPtr;
+	void*						contextPtr;
+} PendingPush_t;
+
+bench_Counters_t							bench_Counters;
+
+static struct le_avdata_Record				_records[BENCH_MAX_RECORDS];
+static struct le_timer						_timers[BENCH_MAX_TIMERS];
+static size_t								_timerCount = 0;
+static PendingPush_t						_pendingPushes[BENCH_MAX_PENDING_PUSHES];
+static size_t								_pendingPushCount = 0;
+static le_avdata_SessionStateHandlerFunc_t	_sessionStateHandlerPtr = NULL;
+static void*								_sessionStateContextPtr = NULL;
+static int32_t								_serverInt = 0;
+static double								_serverFloat = 0;
+static bool									_serverBool = false;
+static uint32_t								_signalQuality = 5;
+
+
+//Allocations of the component
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size)
+{
+	bench_Counters.allocs++;
+	return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+	bench_Counters.allocs++;
+	return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+	bench_Counters.allocs++;
+	return __real_realloc(ptr, size);
+}
+
+//a log message is formatted, as it is on target
+void bench_Log(const char* formatPtr, ...)
+{
+	char	message[256];
+	va_list	args;
+
+	va_start(args, formatPtr);
+	vsnprintf(message, sizeof(message), formatPtr, args);
+	va_end(args);
+
+	bench_Counters.logs++;
+}
+
+//Bench controls
+void bench_StartSession()
+{
+	if (_sessionStateHandlerPtr)
+	{
+		_sessionStateHandlerPtr(LE_AVDATA_SESSION_STARTED, _sessionStateContextPtr);
+	}
+}
+
+void bench_StopSession()
+{
+	if (_sessionStateHandlerPtr)
+	{
+		_sessionStateHandlerPtr(LE_AVDATA_SESSION_STOPPED, _sessionStateContextPtr);
+	}
+}
+
+size_t bench_CompletePushes()
+{
+	size_t count = 0;
+
+	//a callback may issue a new push, it is completed in the same call
+	while (_pendingPushCount)
+	{
+		PendingPush_t push = _pendingPushes[0];
+
+		_pendingPushCount--;
+		memmove(&_pendingPushes[0], &_pendingPushes[1], _pendingPushCount * sizeof(PendingPush_t));
+
+		if (push.handlerPtr)
+		{
+			push.handlerPtr(LE_AVDATA_PUSH_SUCCESS, push.contextPtr);
+		}
+
+		count++;
+	}
+
+	return count;
+}
+
+void bench_SetServerValue(int32_t intValue, double floatValue, bool boolValue)
+{
+	_serverInt = intValue;
+	_serverFloat = floatValue;
+	_serverBool = boolValue;
+}
+
+size_t bench_ExpireTimers(const char* nameStr)
+{
+	size_t	count = 0;
+	size_t	i;
+
+	for (i = 0; i < _timerCount; i++)
+	{
+		le_timer_Ref_t	timerRef = &_timers[i];
+
+		if (timerRef->running && (0 == strcmp(timerRef->namePtr, nameStr)))
+		{
+			timerRef->running = false;
+			timerRef->handlerPtr(timerRef);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+void bench_SetSignalQuality(uint32_t quality)
+{
+	_signalQuality = quality;
+}
+
+//Clock
+static le_clk_Time_t GetClock(clockid_t clockId)
+{
+	struct timespec	now;
+	le_clk_Time_t	time;
+
+	clock_gettime(clockId, &now);
+	time.sec = now.tv_sec;
+	time.usec = now.tv_nsec / 1000;
+
+	return time;
+}
+
+le_clk_Time_t le_clk_GetRelativeTime(void)
+{
+	return GetClock(CLOCK_MONOTONIC);
+}
+
+le_clk_Time_t le_clk_GetAbsoluteTime(void)
+{
+	return GetClock(CLOCK_REALTIME);
+}
+
+le_clk_Time_t le_clk_Add(le_clk_Time_t timeA, le_clk_Time_t timeB)
+{
+	le_clk_Time_t result = { timeA.sec + timeB.sec, timeA.usec + timeB.usec };
+
+	if (result.usec >= 1000000)
+	{
+		result.sec++;
+		result.usec -= 1000000;
+	}
+
+	return result;
+}
+
+le_clk_Time_t le_clk_Sub(le_clk_Time_t timeA, le_clk_Time_t timeB)
+{
+	le_clk_Time_t result = { timeA.sec - timeB.sec, timeA.usec - timeB.usec };
+
+	if (result.usec < 0)
+	{
+		result.sec--;
+		result.usec += 1000000;
+	}
+
+	return result;
+}
+
+bool le_clk_GreaterThan(le_clk_Time_t timeA, le_clk_Time_t timeB)
+{
+	return (timeA.sec > timeB.sec) || ((timeA.sec == timeB.sec) && (timeA.usec > timeB.usec));
+}
+
+//Timers
+le_timer_Ref_t le_timer_Create(const char* nameStr)
+{
+	LE_ASSERT(_timerCount < BENCH_MAX_TIMERS);
+
+	bench_Counters.allocs++;
+	_timers[_timerCount].namePtr = nameStr;
+
+	return &_timers[_timerCount++];
+}
+
+void le_timer_Delete(le_timer_Ref_t timerRef)
+{
+	timerRef->running = false;
+}
+
+le_result_t le_timer_SetHandler(le_timer_Ref_t timerRef, le_timer_ExpiryHandler_t handlerRef)
+{
+	timerRef->handlerPtr = handlerRef;
+	return LE_OK;
+}
+
+le_result_t le_timer_SetInterval(le_timer_Ref_t timerRef, le_clk_Time_t interval)
+{
+	timerRef->intervalMs = interval.sec * 1000 + interval.usec / 1000;
+	return LE_OK;
+}
+
+le_result_t le_timer_SetMsInterval(le_timer_Ref_t timerRef, uint32_t interval)
+{
+	timerRef->intervalMs = interval;
+	return LE_OK;
+}
+
+uint32_t le_timer_GetMsInterval(le_timer_Ref_t timerRef)
+{
+	return timerRef->intervalMs;
+}
+
+le_result_t le_timer_SetRepeat(le_timer_Ref_t timerRef, uint32_t repeatCount)
+{
+	return LE_OK;
+}
+
+le_result_t le_timer_SetContextPtr(le_timer_Ref_t timerRef, void* contextPtr)
+{
+	timerRef->contextPtr = contextPtr;
+	return LE_OK;
+}
+
+void* le_timer_GetContextPtr(le_timer_Ref_t timerRef)
+{
+	return timerRef->contextPtr;
+}
+
+le_result_t le_timer_Start(le_timer_Ref_t timerRef)
+{
+	if (timerRef->running)
+	{
+		return LE_BUSY;
+	}
+
+	timerRef->running = true;
+	return LE_OK;
+}
+
+le_result_t le_timer_Stop(le_timer_Ref_t timerRef)
+{
+	if (!timerRef->running)
+	{
+		return LE_FAULT;
+	}
+
+	timerRef->running = false;
+	return LE_OK;
+}
+
+le_result_t le_timer_Restart(le_timer_Ref_t timerRef)
+{
+	timerRef->running = true;
+	return LE_OK;
+}
+
+bool le_timer_IsRunning(le_timer_Ref_t timerRef)
+{
+	return timerRef->running;
+}
+
+//Signals
+void le_sig_Block(int sigNum)
+{
+}
+
+void le_sig_SetEventHandler(int sigNum, le_sig_EventHandlerFunc_t sigEventHandler)
+{
+}
+
+//Threads
+le_thread_Ref_t le_thread_Create(const char* name, le_thread_MainFunc_t mainFunc, void* contextPtr)
+{
+	return NULL;
+}
+
+void le_thread_Start(le_thread_Ref_t threadRef)
+{
+}
+
+le_thread_Ref_t le_thread_GetCurrent(void)
+{
+	return NULL;
+}
+
+//Semaphores
+le_sem_Ref_t le_sem_Create(const char* name, int32_t initialCount)
+{
+	bench_Counters.allocs++;
+	return (le_sem_Ref_t)&_serverInt;
+}
+
+void le_sem_Post(le_sem_Ref_t semaphorePtr)
+{
+}
+
+void le_sem_Wait(le_sem_Ref_t semaphorePtr)
+{
+}
+
+le_result_t le_sem_WaitWithTimeout(le_sem_Ref_t semaphorePtr, le_clk_Time_t timeToWait)
+{
+	return LE_OK;
+}
+
+//Deferred functions
+void le_event_QueueFunction(le_event_DeferredFunc_t func, void* param1Ptr, void* param2Ptr)
+{
+	func(param1Ptr, param2Ptr);
+}
+
+void le_event_QueueFunctionToThread(le_thread_Ref_t thread, le_event_DeferredFunc_t func, void* param1Ptr, void* param2Ptr)
+{
+	func(param1Ptr, param2Ptr);
+}
+
+//Memory pools
+le_mem_PoolRef_t le_mem_CreatePool(const char* name, size_t objSize)
+{
+	le_mem_PoolRef_t pool = __real_calloc(1, sizeof(struct le_mem_Pool));
+
+	LE_ASSERT(pool);
+	pool->objSize = objSize;
+
+	return pool;
+}
+
+le_mem_PoolRef_t le_mem_ExpandPool(le_mem_PoolRef_t pool, size_t numObjects)
+{
+	return pool;
+}
+
+void* le_mem_TryAlloc(le_mem_PoolRef_t pool)
+{
+	bench_Counters.allocs++;
+	return __real_calloc(1, pool->objSize);
+}
+
+void* le_mem_ForceAlloc(le_mem_PoolRef_t pool)
+{
+	void* objPtr = le_mem_TryAlloc(pool);
+
+	LE_ASSERT(objPtr);
+
+	return objPtr;
+}
+
+void le_mem_Release(void* objPtr)
+{
+	free(objPtr);
+}
+
+//le_avdata
+le_result_t le_avdata_CreateResource(const char* path, le_avdata_AccessMode_t accessMode)
+{
+	bench_Counters.ipc++;
+	return LE_OK;
+}
+
+le_result_t le_avdata_SetNamespace(le_avdata_Namespace_t namespace)
+{
+	bench_Counters.ipc++;
+	return LE_OK;
+}
+
+le_result_t le_avdata_SetInt(const char* path, int32_t value)
+{
+	bench_Counters.ipc++;
+	return LE_OK;
+}
+
+le_result_t le_avdata_GetInt(const char* path, int32_t* valuePtr)
+{
+	bench_Counters.ipc++;
+	*valuePtr = _serverInt;
+	return LE_OK;
+}
+
+le_result_t le_avdata_SetFloat(const char* path, double value)
+{
+	bench_Counters.ipc++;
+	return LE_OK;
+}
+
+le_result_t le_avdata_GetFloat(const char* path, double* valuePtr)
+{
+	bench_Counters.ipc++;
+	*valuePtr = _serverFloat;
+	return LE_OK;
+}
+
+le_result_t le_avdata_SetBool(const char* path, bool value)
+{
+	bench_Counters.ipc++;
+	return LE_OK;
+}
+
+le_result_t le_avdata_GetBool(const char* path, bool* valuePtr)
+{
+	bench_Counters.ipc++;
+	*valuePtr = _serverBool;
+	return LE_OK;
+}
+
+le_avdata_ResourceEventHandlerRef_t le_avdata_AddResourceEventHandler(const char* path, le_avdata_ResourceHandlerFunc_t handlerPtr, void* contextPtr)
+{
+	bench_Counters.ipc++;
+	return (le_avdata_ResourceEventHandlerRef_t)handlerPtr;
+}
+
+void le_avdata_ReplyExecResult(le_avdata_ArgumentListRef_t argumentListRef, le_result_t result)
+{
+	bench_Counters.ipc++;
+}
+
+//queue the callback of a push, until bench_CompletePushes()
+static le_result_t QueuePush(le_avdata_CallbackFunc_t handlerPtr, void* contextPtr)
+{
+	if (_pendingPushCount >= BENCH_MAX_PENDING_PUSHES)
+	{
+		return LE_BUSY;
+	}
+
+	_pendingPushes[_pendingPushCount].handlerPtr = handlerPtr;
+	_pendingPushes[_pendingPushCount].contextPtr = contextPtr;
+	_pendingPushCount++;
+
+	return LE_OK;
+}
+
+le_result_t le_avdata_Push(const char* path, le_avdata_CallbackFunc_t handlerPtr, void* contextPtr)
+{
+	bench_Counters.ipc++;
+	return QueuePush(handlerPtr, contextPtr);
+}
+
+le_avdata_RecordRef_t le_avdata_CreateRecord(void)
+{
+	size_t i;
+
+	bench_Counters.ipc++;
+
+	for (i = 0; i < BENCH_MAX_RECORDS; i++)
+	{
+		if (!_records[i].used)
+		{
+			_records[i].used = true;
+			_records[i].sampleCount = 0;
+			return &_records[i];
+		}
+	}
+
+	return NULL;
+}
+
+void le_avdata_DeleteRecord(le_avdata_RecordRef_t recordRef)
+{
+	bench_Counters.ipc++;
+	recordRef->used = false;
+}
+
+//add a sample to a record, within its capacity
+static le_result_t RecordSample(le_avdata_RecordRef_t recordRef)
+{
+	bench_Counters.ipc++;
+
+	if (recordRef->sampleCount >= BENCH_RECORD_MAX_SAMPLES)
+	{
+		return LE_NO_MEMORY;
+	}
+
+	recordRef->sampleCount++;
+	return LE_OK;
+}
+
+le_result_t le_avdata_RecordInt(le_avdata_RecordRef_t recordRef, const char* path, int32_t value, uint64_t timestamp)
+{
+	return RecordSample(recordRef);
+}
+
+le_result_t le_avdata_RecordFloat(le_avdata_RecordRef_t recordRef, const char* path, double value, uint64_t timestamp)
+{
+	return RecordSample(recordRef);
+}
+
+le_result_t le_avdata_RecordBool(le_avdata_RecordRef_t recordRef, const char* path, bool value, uint64_t timestamp)
+{
+	return RecordSample(recordRef);
+}
+
+//avcService clears a record once it has been pushed
+le_result_t le_avdata_PushRecord(le_avdata_RecordRef_t recordRef, le_avdata_CallbackFunc_t handlerPtr, void* contextPtr)
+{
+	bench_Counters.ipc++;
+	recordRef->sampleCount = 0;
+	return QueuePush(handlerPtr, contextPtr);
+}
+
+le_avdata_RequestSessionObjRef_t le_avdata_RequestSession(void)
+{
+	bench_Counters.ipc++;
+	return (le_avdata_RequestSessionObjRef_t)&_sessionStateHandlerPtr;
+}
+
+void le_avdata_ReleaseSession(le_avdata_RequestSessionObjRef_t sessionRequestRef)
+{
+	bench_Counters.ipc++;
+}
+
+le_avdata_SessionStateHandlerRef_t le_avdata_AddSessionStateHandler(le_avdata_SessionStateHandlerFunc_t handlerPtr, void* contextPtr)
+{
+	bench_Counters.ipc++;
+	_sessionStateHandlerPtr = handlerPtr;
+	_sessionStateContextPtr = contextPtr;
+	return (le_avdata_SessionStateHandlerRef_t)handlerPtr;
+}
+
+//le_pos, le_posCtrl : a 3D fix, the truck never moves
+le_result_t le_pos_GetFixState(le_pos_FixState_t* statePtr)
+{
+	bench_Counters.ipc++;
+	*statePtr = LE_POS_STATE_FIX_3D;
+	return LE_OK;
+}
+
+le_result_t le_pos_Get2DLocation(int32_t* latitudePtr, int32_t* longitudePtr, int32_t* hAccuracyPtr)
+{
+	bench_Counters.ipc++;
+	*latitudePtr = 43610000;
+	*longitudePtr = 1440000;
+	*hAccuracyPtr = 10;
+	return LE_OK;
+}
+
+le_result_t le_pos_Get3DLocation(int32_t* latitudePtr, int32_t* longitudePtr, int32_t* hAccuracyPtr, int32_t* altitudePtr, int32_t* vAccuracyPtr)
+{
+	le_pos_Get2DLocation(latitudePtr, longitudePtr, hAccuracyPtr);
+	*altitudePtr = 150000;
+	*vAccuracyPtr = 20;
+	return LE_OK;
+}
+
+le_pos_MovementHandlerRef_t le_pos_AddMovementHandler(uint32_t horizontalMagnitude, uint32_t verticalMagnitude, le_pos_MovementHandlerFunc_t handlerPtr, void* contextPtr)
+{
+	bench_Counters.ipc++;
+	return (le_pos_MovementHandlerRef_t)handlerPtr;
+}
+
+void le_pos_RemoveMovementHandler(le_pos_MovementHandlerRef_t handlerRef)
+{
+	bench_Counters.ipc++;
+}
+
+le_result_t le_pos_sample_GetFixState(le_pos_SampleRef_t positionSampleRef, le_pos_FixState_t* statePtr)
+{
+	return le_pos_GetFixState(statePtr);
+}
+
+le_result_t le_pos_sample_Get2DLocation(le_pos_SampleRef_t positionSampleRef, int32_t* latitudePtr, int32_t* longitudePtr, int32_t* hAccuracyPtr)
+{
+	return le_pos_Get2DLocation(latitudePtr, longitudePtr, hAccuracyPtr);
+}
+
+le_result_t le_pos_sample_GetAltitude(le_pos_SampleRef_t positionSampleRef, int32_t* altitudePtr, int32_t* vAccuracyPtr)
+{
+	bench_Counters.ipc++;
+	*altitudePtr = 150000;
+	*vAccuracyPtr = 20;
+	return LE_OK;
+}
+
+void le_pos_sample_Release(le_pos_SampleRef_t positionSampleRef)
+{
+	bench_Counters.ipc++;
+}
+
+le_posCtrl_ActivationRef_t le_posCtrl_Request(void)
+{
+	bench_Counters.ipc++;
+	return (le_posCtrl_ActivationRef_t)&_serverInt;
+}
+
+void le_posCtrl_Release(le_posCtrl_ActivationRef_t ref)
+{
+	bench_Counters.ipc++;
+}
+
+void le_pos_ConnectService(void)
+{
+	bench_Counters.ipc++;
+}
+
+//le_mrc
+le_result_t le_mrc_GetSignalQual(uint32_t* qualityPtr)
+{
+	bench_Counters.ipc++;
+	*qualityPtr = _signalQuality;
+	return LE_OK;
+}
+
+le_result_t le_mrc_GetRadioAccessTechInUse(le_mrc_Rat_t* ratPtr)
+{
+	bench_Counters.ipc++;
+	*ratPtr = LE_MRC_RAT_LTE;
+	return LE_OK;
+}
+
+//le_cfg
+void le_cfg_ConnectService(void)
+{
+	bench_Counters.ipc++;
+}
+
+le_cfg_IteratorRef_t le_cfg_CreateReadTxn(const char* basePath)
+{
+	bench_Counters.ipc++;
+	return (le_cfg_IteratorRef_t)&_serverInt;
+}
+
+le_cfg_IteratorRef_t le_cfg_CreateWriteTxn(const char* basePath)
+{
+	bench_Counters.ipc++;
+	return (le_cfg_IteratorRef_t)&_serverInt;
+}
+
+void le_cfg_CommitTxn(le_cfg_IteratorRef_t iteratorRef)
+{
+	bench_Counters.ipc++;
+}
+
+void le_cfg_CancelTxn(le_cfg_IteratorRef_t iteratorRef)
+{
+	bench_Counters.ipc++;
+}
+
+bool le_cfg_NodeExists(le_cfg_IteratorRef_t iteratorRef, const char* path)
+{
+	bench_Counters.ipc++;
+	return false;
+}
+
+int32_t le_cfg_GetInt(le_cfg_IteratorRef_t iteratorRef, const char* path, int32_t defaultValue)
+{
+	bench_Counters.ipc++;
+	return defaultValue;
+}
+
+void le_cfg_SetInt(le_cfg_IteratorRef_t iteratorRef, const char* path, int32_t value)
+{
+	bench_Counters.ipc++;
+}
+
+double le_cfg_GetFloat(le_cfg_IteratorRef_t iteratorRef, const char* path, double defaultValue)
+{
+	bench_Counters.ipc++;
+	return defaultValue;
+}
+
+void le_cfg_SetFloat(le_cfg_IteratorRef_t iteratorRef, const char* path, double value)
+{
+	bench_Counters.ipc++;
+}
+
+bool le_cfg_GetBool(le_cfg_IteratorRef_t iteratorRef, const char* path, bool defaultValue)
+{
+	bench_Counters.ipc++;
+	return defaultValue;
+}
+
+void le_cfg_SetBool(le_cfg_IteratorRef_t iteratorRef, const char* path, bool value)
+{
+	bench_Counters.ipc++;
+}
+
+void le_cfg_DeleteNode(le_cfg_IteratorRef_t iteratorRef, const char* path)
+{
+	bench_Counters.ipc++;
+}
+
+int32_t le_cfg_QuickGetInt(const char* path, int32_t defaultValue)
+{
+	bench_Counters.ipc++;
+	return defaultValue;
+}
+
+void le_cfg_QuickSetInt(const char* path, int32_t value)
+{
+	bench_Counters.ipc++;
+}
+
+//le_gpioPinN : the state of every pin is kept, an output reads back its level, an input calls its change handler when driven by the bench
+#define BENCH_GPIO_PIN_STUB(N)																												\
+	static struct { bool level; bool input; le_gpio_Polarity_t polarity; le_gpio_PullUpDown_t pull; le_gpio_Edge_t edge;					\
+					le_gpioPin##N##_ChangeCallbackFunc_t handlerPtr; void* contextPtr; } _pin##N;											\
+	static void SetInput##N(bool level)																										\
+	{																																		\
+		bool	changed = (level != _pin##N.level);																							\
+		_pin##N.level = level;																												\
+		if (_pin##N.input && _pin##N.handlerPtr && changed &&																				\
+			((LE_GPIO_EDGE_BOTH == _pin##N.edge) || ((LE_GPIO_EDGE_RISING == _pin##N.edge) == level)))										\
+		{ _pin##N.handlerPtr(level, _pin##N.contextPtr); }																					\
+	}																																		\
+	le_result_t le_gpioPin##N##_SetInput(le_gpio_Polarity_t polarity)																		\
+		{ bench_Counters.ipc++; _pin##N.input = true; _pin##N.polarity = polarity; return LE_OK; }											\
+	le_result_t le_gpioPin##N##_SetPushPullOutput(le_gpio_Polarity_t polarity, bool value)													\
+		{ bench_Counters.ipc++; _pin##N.input = false; _pin##N.polarity = polarity; _pin##N.level = value; return LE_OK; }					\
+	le_result_t le_gpioPin##N##_Activate(void)						{ bench_Counters.ipc++; _pin##N.level = true; return LE_OK; }			\
+	le_result_t le_gpioPin##N##_Deactivate(void)					{ bench_Counters.ipc++; _pin##N.level = false; return LE_OK; }			\
+	bool le_gpioPin##N##_Read(void)									{ bench_Counters.ipc++; return _pin##N.level; }							\
+	bool le_gpioPin##N##_IsInput(void)								{ bench_Counters.ipc++; return _pin##N.input; }							\
+	le_gpio_Polarity_t le_gpioPin##N##_GetPolarity(void)			{ bench_Counters.ipc++; return _pin##N.polarity; }						\
+	le_gpio_PullUpDown_t le_gpioPin##N##_GetPullUpDown(void)		{ bench_Counters.ipc++; return _pin##N.pull; }							\
+	le_result_t le_gpioPin##N##_EnablePullUp(void)					{ bench_Counters.ipc++; _pin##N.pull = LE_GPIO_PULL_UP; return LE_OK; }	\
+	le_result_t le_gpioPin##N##_EnablePullDown(void)				{ bench_Counters.ipc++; _pin##N.pull = LE_GPIO_PULL_DOWN; return LE_OK; }\
+	le_gpio_Edge_t le_gpioPin##N##_GetEdgeSense(void)				{ bench_Counters.ipc++; return _pin##N.edge; }							\
+	le_gpioPin##N##_ChangeEventHandlerRef_t le_gpioPin##N##_AddChangeEventHandler(le_gpio_Edge_t trigger,									\
+		le_gpioPin##N##_ChangeCallbackFunc_t handlerPtr, void* contextPtr, int32_t sampleMs)												\
+		{ bench_Counters.ipc++; _pin##N.edge = trigger; _pin##N.handlerPtr = handlerPtr; _pin##N.contextPtr = contextPtr;					\
+		  return (le_gpioPin##N##_ChangeEventHandlerRef_t)handlerPtr; }
+
+BENCH_GPIO_PIN_STUB(7)
+BENCH_GPIO_PIN_STUB(8)
+BENCH_GPIO_PIN_STUB(13)
+BENCH_GPIO_PIN_STUB(33)
+BENCH_GPIO_PIN_STUB(42)
+
+void bench_SetInputs(bool level)
+{
+	SetInput7(level);
+	SetInput8(level);
+	SetInput13(level);
+	SetInput33(level);
+	SetInput42(level);
+}
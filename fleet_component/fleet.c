@@ -0,0 +1,382 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file fleet.c
+ *
+ * Headless fleet load generator, to size the AirVantage backend (localhost target):
+ *      Thousands of virtual trucks are simulated in one process, with the thermal model of the truck app
+ *      The trucks are spread over a pool of worker threads, each one owns its trucks, its avcService connection,
+ *      and batches the samples of its trucks into timeserie records
+ *      The simulated clock runs timeScale times faster than the real one
+ *      Aggregate samples/s and push ack throughput are logged every report interval
+ *
+ *    Options : --trucks=N --workers=N --timeScale=N --interval=<simulated seconds> --batch=<samples per push> --report=<seconds>
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "thermal.h"	//Use thermal helper lib of the truck app to simulate the temperature of every truck
+
+#define FLEET_MAX_WORKERS					64
+#define FLEET_PATH_MAX						48
+#define FLEET_OUTSIDE_TEMP					27.0
+#define FLEET_FAN_RESTART_TEMP				5.0         //stands for the AirVantage rule starting the fan above 5°C
+
+//Virtual truck variables, the path is a format taking the truck index
+#define FLEET_VARIABLE_TEMP_CURRENT			"fleet.truck[%d].temp.current"
+#define FLEET_VARIABLE_FAN_DURATION			"fleet.truck[%d].fan.duration"
+
+//Counters of a worker, read by the main thread under the worker mutex
+typedef struct
+{
+	uint64_t				samples;
+	uint64_t				pushes;
+	uint64_t				acks;
+	uint64_t				failures;
+	uint64_t				dropped;			//samples which did not fit in a record
+	uint64_t				inFlight;
+} FleetStats_t;
+
+//A worker thread and the slice of trucks it owns
+typedef struct
+{
+	char					name[16];
+	le_thread_Ref_t			threadRef;
+	le_timer_Ref_t			tickTimerRef;
+	int						firstTruck;
+	int						truckCount;
+	thermal_Zones_t			trucks;				//points in the fleet arrays, from firstTruck
+	double*					convergedToPtr;
+	bool*					stoppedPtr;
+	uint64_t				tick;
+	le_avdata_RecordRef_t	recordRef;
+	int						recordSamples;
+	le_mutex_Ref_t			statsMutex;
+	FleetStats_t			stats;
+} FleetWorker_t;
+
+//Options
+static int									_truckCount = 1000;
+static int									_workerCount = 4;
+static int									_timeScale = 60;					//simulated seconds per real second
+static int									_dataGenInterval = 5;				//simulated seconds between 2 samples of a truck
+static int									_batchSamples = 256;				//samples per push
+static int									_reportInterval = 10;				//real seconds between 2 throughput reports
+
+//State of every truck, one array per field
+static struct
+{
+	double*									temperaturePtr;
+	double*									targetPtr;
+	int*									fanDurationPtr;
+	double*									fanDurationRawPtr;
+	bool*									fanIsOnPtr;
+	bool*									doorIsOpenPtr;
+	char									(*pathsPtr)[2][FLEET_PATH_MAX];
+} _fleet;
+
+static FleetWorker_t						_workers[FLEET_MAX_WORKERS];
+static uint64_t								_simStartMilliSec;
+static le_clk_Time_t						_reportTime;
+static FleetStats_t							_reportedStats;
+
+
+//current time, as a timeserie timestamp (UTC in milliseconds)
+static uint64_t GetUtcMilliSec()
+{
+	le_clk_Time_t now = le_clk_GetAbsoluteTime();
+
+	return (uint64_t)now.sec * 1000 + (uint64_t)now.usec / 1000;
+}
+
+//Callback of a worker push, called in the worker thread
+static void OnPushResult
+(
+	le_avdata_PushStatus_t status,
+	void* contextPtr
+)
+{
+	FleetWorker_t* workerPtr = contextPtr;
+
+	le_mutex_Lock(workerPtr->statsMutex);
+	workerPtr->stats.inFlight--;
+	if (status == LE_AVDATA_PUSH_SUCCESS)
+	{
+		workerPtr->stats.acks++;
+	}
+	else
+	{
+		workerPtr->stats.failures++;
+	}
+	le_mutex_Unlock(workerPtr->statsMutex);
+}
+
+//Push the record of a worker, a new one is created with the next sample
+static void PushBatch(FleetWorker_t* workerPtr)
+{
+	le_result_t result = le_avdata_PushRecord(workerPtr->recordRef, OnPushResult, workerPtr);
+
+	le_avdata_DeleteRecord(workerPtr->recordRef);
+	workerPtr->recordRef = NULL;
+	workerPtr->recordSamples = 0;
+
+	le_mutex_Lock(workerPtr->statsMutex);
+	if (LE_OK == result)
+	{
+		workerPtr->stats.pushes++;
+		workerPtr->stats.inFlight++;
+	}
+	else
+	{
+		workerPtr->stats.failures++;
+	}
+	le_mutex_Unlock(workerPtr->statsMutex);
+}
+
+//Record the samples of a truck in the record of its worker, the record is pushed once it holds a batch
+//returns the number of samples recorded
+static int RecordTruck(FleetWorker_t* workerPtr, int truck, uint64_t utcMilliSec)
+{
+	if (NULL == workerPtr->recordRef)
+	{
+		workerPtr->recordRef = le_avdata_CreateRecord();
+	}
+
+	int			recorded = 0;
+	le_result_t	result = le_avdata_RecordFloat(workerPtr->recordRef, _fleet.pathsPtr[truck][0], _fleet.temperaturePtr[truck], utcMilliSec);
+
+	if (LE_OK == result)
+	{
+		recorded++;
+		result = le_avdata_RecordInt(workerPtr->recordRef, _fleet.pathsPtr[truck][1], _fleet.fanDurationPtr[truck], utcMilliSec);
+	}
+
+	if (LE_OK == result)
+	{
+		recorded++;
+	}
+
+	//a full record is pushed right away, with the temperature sample if only the fan duration did not fit
+	if ((LE_OK != result) || ((workerPtr->recordSamples += recorded) >= _batchSamples))
+	{
+		PushBatch(workerPtr);
+	}
+
+	return recorded;
+}
+
+//Tick of a worker : one simulated data generation interval for each of its trucks
+static void OnWorkerTick(le_timer_Ref_t timerRef)
+{
+	FleetWorker_t*	workerPtr = le_timer_GetContextPtr(timerRef);
+	uint64_t		utcMilliSec = _simStartMilliSec + workerPtr->tick * _dataGenInterval * 1000;
+	int				samples = 0;
+	int				i;
+
+	workerPtr->tick++;
+
+	thermal_Advance(&workerPtr->trucks, workerPtr->truckCount, FLEET_OUTSIDE_TEMP, _dataGenInterval,
+					workerPtr->convergedToPtr, workerPtr->stoppedPtr);
+
+	for (i = 0; i < workerPtr->truckCount; i++)
+	{
+		if (workerPtr->stoppedPtr[i])
+		{
+			thermal_ResetFanDuration(&workerPtr->trucks, i);
+		}
+		else if (!workerPtr->trucks.fanIsOnPtr[i] && (workerPtr->trucks.temperaturePtr[i] > FLEET_FAN_RESTART_TEMP))
+		{
+			workerPtr->trucks.fanIsOnPtr[i] = true;
+		}
+
+		samples += RecordTruck(workerPtr, workerPtr->firstTruck + i, utcMilliSec);
+	}
+
+	le_mutex_Lock(workerPtr->statsMutex);
+	workerPtr->stats.samples += samples;
+	workerPtr->stats.dropped += 2 * workerPtr->truckCount - samples;
+	le_mutex_Unlock(workerPtr->statsMutex);
+}
+
+//Session state of a worker, called in the worker thread : its trucks only tick while its session is started
+static void OnWorkerSessionState
+(
+	le_avdata_SessionState_t sessionState,
+	void* contextPtr
+)
+{
+	FleetWorker_t* workerPtr = contextPtr;
+
+	LE_INFO("%s : AirVantage session %s", workerPtr->name, (LE_AVDATA_SESSION_STARTED == sessionState) ? "started" : "stopped");
+
+	if (LE_AVDATA_SESSION_STARTED == sessionState)
+	{
+		if (!le_timer_IsRunning(workerPtr->tickTimerRef))
+		{
+			le_timer_Start(workerPtr->tickTimerRef);
+		}
+	}
+	else
+	{
+		le_timer_Stop(workerPtr->tickTimerRef);
+	}
+}
+
+//Main function of a worker thread : its own avcService connection and session, its trucks ticked by its own timer
+static void* WorkerMain(void* contextPtr)
+{
+	FleetWorker_t*	workerPtr = contextPtr;
+	int				tickMs = ((_dataGenInterval * 1000) / _timeScale > 0) ? (_dataGenInterval * 1000) / _timeScale : 1;
+
+	le_avdata_ConnectService();
+	le_avdata_SetNamespace(LE_AVDATA_NAMESPACE_GLOBAL);
+
+	//started once the session is
+	workerPtr->tickTimerRef = le_timer_Create(workerPtr->name);
+	le_timer_SetMsInterval(workerPtr->tickTimerRef, tickMs);
+	le_timer_SetRepeat(workerPtr->tickTimerRef, 0);
+	le_timer_SetContextPtr(workerPtr->tickTimerRef, workerPtr);
+	le_timer_SetHandler(workerPtr->tickTimerRef, OnWorkerTick);
+
+	le_avdata_AddSessionStateHandler(OnWorkerSessionState, workerPtr);
+	le_avdata_RequestSession();
+
+	LE_INFO("%s : trucks %d to %d, ticking every %d ms once the session is started", workerPtr->name, workerPtr->firstTruck,
+			workerPtr->firstTruck + workerPtr->truckCount - 1, tickMs);
+
+	le_event_RunLoop();
+
+	return NULL;
+}
+
+//Report timer : aggregate throughput of every worker since the last report
+static void OnReportTimer(le_timer_Ref_t timerRef)
+{
+	FleetStats_t	total = { 0 };
+	le_clk_Time_t	now = le_clk_GetRelativeTime();
+	le_clk_Time_t	elapsed = le_clk_Sub(now, _reportTime);
+	double			seconds = elapsed.sec + elapsed.usec / 1000000.0;
+	int				i;
+
+	for (i = 0; i < _workerCount; i++)
+	{
+		le_mutex_Lock(_workers[i].statsMutex);
+		total.samples += _workers[i].stats.samples;
+		total.pushes += _workers[i].stats.pushes;
+		total.acks += _workers[i].stats.acks;
+		total.failures += _workers[i].stats.failures;
+		total.dropped += _workers[i].stats.dropped;
+		total.inFlight += _workers[i].stats.inFlight;
+		le_mutex_Unlock(_workers[i].statsMutex);
+	}
+
+	if (seconds > 0)
+	{
+		LE_INFO("Fleet : %d trucks, %.0f samples/s, %.1f pushes/s, %.1f acks/s, %" PRIu64 " failed, %" PRIu64 " dropped, %" PRIu64 " in flight",
+				_truckCount,
+				(total.samples - _reportedStats.samples) / seconds,
+				(total.pushes - _reportedStats.pushes) / seconds,
+				(total.acks - _reportedStats.acks) / seconds,
+				total.failures, total.dropped, total.inFlight);
+	}
+
+	_reportedStats = total;
+	_reportTime = now;
+}
+
+//allocate the state of every truck, each one gets its own target and starting temperature
+static void CreateTrucks()
+{
+	int truck;
+
+	_fleet.temperaturePtr = calloc(_truckCount, sizeof(double));
+	_fleet.targetPtr = calloc(_truckCount, sizeof(double));
+	_fleet.fanDurationPtr = calloc(_truckCount, sizeof(int));
+	_fleet.fanDurationRawPtr = calloc(_truckCount, sizeof(double));
+	_fleet.fanIsOnPtr = calloc(_truckCount, sizeof(bool));
+	_fleet.doorIsOpenPtr = calloc(_truckCount, sizeof(bool));
+	_fleet.pathsPtr = calloc(_truckCount, sizeof(*_fleet.pathsPtr));
+
+	LE_ASSERT(_fleet.temperaturePtr && _fleet.targetPtr && _fleet.fanDurationPtr && _fleet.fanDurationRawPtr &&
+			  _fleet.fanIsOnPtr && _fleet.doorIsOpenPtr && _fleet.pathsPtr);
+
+	for (truck = 0; truck < _truckCount; truck++)
+	{
+		_fleet.temperaturePtr[truck] = 4.2 + (truck % 7) * 0.3;
+		_fleet.targetPtr[truck] = 2.2 + (truck % 5) * 0.5;
+		_fleet.fanIsOnPtr[truck] = true;
+
+		snprintf(_fleet.pathsPtr[truck][0], FLEET_PATH_MAX, FLEET_VARIABLE_TEMP_CURRENT, truck);
+		snprintf(_fleet.pathsPtr[truck][1], FLEET_PATH_MAX, FLEET_VARIABLE_FAN_DURATION, truck);
+	}
+}
+
+//split the trucks over the workers and start them
+static void StartWorkers()
+{
+	int i;
+	int firstTruck = 0;
+
+	for (i = 0; i < _workerCount; i++)
+	{
+		FleetWorker_t*	workerPtr = &_workers[i];
+		int				truckCount = _truckCount / _workerCount + (i < _truckCount % _workerCount);
+
+		snprintf(workerPtr->name, sizeof(workerPtr->name), "fleetWorker%d", i);
+		workerPtr->firstTruck = firstTruck;
+		workerPtr->truckCount = truckCount;
+		workerPtr->trucks.temperaturePtr = &_fleet.temperaturePtr[firstTruck];
+		workerPtr->trucks.targetPtr = &_fleet.targetPtr[firstTruck];
+		workerPtr->trucks.fanDurationPtr = &_fleet.fanDurationPtr[firstTruck];
+		workerPtr->trucks.fanDurationRawPtr = &_fleet.fanDurationRawPtr[firstTruck];
+		workerPtr->trucks.fanIsOnPtr = &_fleet.fanIsOnPtr[firstTruck];
+		workerPtr->trucks.doorIsOpenPtr = &_fleet.doorIsOpenPtr[firstTruck];
+		workerPtr->convergedToPtr = calloc(truckCount, sizeof(double));
+		workerPtr->stoppedPtr = calloc(truckCount, sizeof(bool));
+		workerPtr->statsMutex = le_mutex_CreateNonRecursive(workerPtr->name);
+
+		LE_ASSERT(workerPtr->convergedToPtr && workerPtr->stoppedPtr);
+
+		workerPtr->threadRef = le_thread_Create(workerPtr->name, WorkerMain, workerPtr);
+		le_thread_Start(workerPtr->threadRef);
+
+		firstTruck += truckCount;
+	}
+}
+
+//main start
+COMPONENT_INIT
+{
+	le_arg_SetIntVar(&_truckCount, "n", "trucks");
+	le_arg_SetIntVar(&_workerCount, "w", "workers");
+	le_arg_SetIntVar(&_timeScale, "s", "timeScale");
+	le_arg_SetIntVar(&_dataGenInterval, "g", "interval");
+	le_arg_SetIntVar(&_batchSamples, "b", "batch");
+	le_arg_SetIntVar(&_reportInterval, "r", "report");
+	le_arg_Scan();
+
+	if ((_truckCount < 1) || (_workerCount < 1) || (_timeScale < 1) || (_dataGenInterval < 1) ||
+		(_batchSamples < 2) || (_reportInterval < 1))
+	{
+		LE_FATAL("Invalid fleet options");
+	}
+
+	//no idle worker
+	_workerCount = (_workerCount > FLEET_MAX_WORKERS) ? FLEET_MAX_WORKERS : _workerCount;
+	_workerCount = (_workerCount > _truckCount) ? _truckCount : _workerCount;
+
+	LE_INFO("Starting fleet load generator : %d trucks, %d workers, time x%d", _truckCount, _workerCount, _timeScale);
+
+	_simStartMilliSec = GetUtcMilliSec();
+	_reportTime = le_clk_GetRelativeTime();
+
+	CreateTrucks();
+	StartWorkers();
+
+	le_timer_Ref_t reportTimerRef = le_timer_Create("fleetReport");
+	le_timer_SetMsInterval(reportTimerRef, _reportInterval * 1000);
+	le_timer_SetRepeat(reportTimerRef, 0);
+	le_timer_SetHandler(reportTimerRef, OnReportTimer);
+	le_timer_Start(reportTimerRef);
+}
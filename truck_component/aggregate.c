@@ -0,0 +1,47 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file aggregate.c
+ *
+ * Helper lib summarizing a value over a time window, in O(1) memory:
+ *      min, max, mean, count and last value of the samples added since the window was reset
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+#include "aggregate.h"
+
+
+//start a new window
+void aggregate_Reset(aggregate_Window_t* windowPtr)
+{
+	windowPtr->count = 0;
+	windowPtr->min = 0;
+	windowPtr->max = 0;
+	windowPtr->sum = 0;
+	windowPtr->last = 0;
+}
+
+//add a sample to the window
+void aggregate_Add(aggregate_Window_t* windowPtr, double value)
+{
+	if ((0 == windowPtr->count) || (value < windowPtr->min))
+	{
+		windowPtr->min = value;
+	}
+
+	if ((0 == windowPtr->count) || (value > windowPtr->max))
+	{
+		windowPtr->max = value;
+	}
+
+	windowPtr->sum += value;
+	windowPtr->last = value;
+	windowPtr->count++;
+}
+
+//mean of the samples of the window
+double aggregate_GetMean(const aggregate_Window_t* windowPtr)
+{
+	return windowPtr->count ? windowPtr->sum / windowPtr->count : 0;
+}
@@ -0,0 +1,33 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file aggregate.h
+ *
+ * Helper lib summarizing a value over a time window, in O(1) memory:
+ *      min, max, mean, count and last value of the samples added since the window was reset
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _AGGREGATE_H_
+#define _AGGREGATE_H_
+
+//Running summary of the samples of a window
+typedef struct
+{
+	uint32_t	count;
+	double		min;
+	double		max;
+	double		sum;
+	double		last;
+} aggregate_Window_t;
+
+
+//Start a new window
+void aggregate_Reset(aggregate_Window_t* windowPtr);
+
+//Add a sample to the window
+void aggregate_Add(aggregate_Window_t* windowPtr, double value);
+
+//Mean of the samples of the window, 0 if the window is empty
+double aggregate_GetMean(const aggregate_Window_t* windowPtr);
+
+#endif //_AGGREGATE_H_
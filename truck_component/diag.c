@@ -0,0 +1,195 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file diag.c
+ *
+ * Helper lib measuring the hot paths of the app, published as AirVantage diagnostic variables (truck.var.diag.*):
+ *      data generation tick duration, push latency (issue to callback), push outcomes,
+ *      GNSS fix age, radio signal quality, GPIO calls to gpioService, and depth of the pending queues
+ *      Durations are summarized (mean, max) over the publication period, counts are per period
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "diag.h"
+#include "aggregate.h"
+#include "session.h"
+#include "record.h"
+#include "store.h"
+#include "position.h"
+#include "gpio_iot.h"
+#include "uplink.h"
+
+//Diagnostic variables
+#define DIAG_TICK_MEAN				"truck.var.diag.tick.mean"			//int : mean duration of a data generation tick (microseconds)
+#define DIAG_TICK_MAX				"truck.var.diag.tick.max"			//int : max duration of a data generation tick (microseconds)
+#define DIAG_PUSH_LATENCY_MEAN		"truck.var.diag.push.latencyMean"	//int : mean time from push to callback (milliseconds)
+#define DIAG_PUSH_LATENCY_MAX		"truck.var.diag.push.latencyMax"	//int : max time from push to callback (milliseconds)
+#define DIAG_PUSH_OK				"truck.var.diag.push.ok"			//int : pushes acknowledged over the period
+#define DIAG_PUSH_FAILED			"truck.var.diag.push.failed"		//int : pushes failed over the period
+#define DIAG_PUSH_IN_FLIGHT			"truck.var.diag.push.inFlight"		//int : pushes waiting for their callback
+#define DIAG_PUSH_STALLS			"truck.var.diag.push.stalls"		//int : times the cap of pushes in flight was reached, since start
+#define DIAG_GNSS_FIX_AGE			"truck.var.diag.gnss.fixAge"		//int : age of the last fix (seconds), -1 if none
+#define DIAG_RADIO_QUALITY			"truck.var.diag.radio.quality"		//int : last signal quality read (0-5), -1 if unknown
+#define DIAG_GPIO_CALLS				"truck.var.diag.gpio.calls"			//int : calls to gpioService over the period
+#define DIAG_QUEUE_STORE			"truck.var.diag.queue.store"		//int : samples on flash waiting for replay
+#define DIAG_QUEUE_DROPPED			"truck.var.diag.queue.dropped"		//int : samples dropped because the store was full, since start
+#define DIAG_QUEUE_RECORDS			"truck.var.diag.queue.records"		//int : timeserie records alive in avcService
+
+static const char*					_diagPaths[] =
+{
+	DIAG_TICK_MEAN, DIAG_TICK_MAX,
+	DIAG_PUSH_LATENCY_MEAN, DIAG_PUSH_LATENCY_MAX, DIAG_PUSH_OK, DIAG_PUSH_FAILED, DIAG_PUSH_IN_FLIGHT, DIAG_PUSH_STALLS,
+	DIAG_GNSS_FIX_AGE,
+	DIAG_RADIO_QUALITY,
+	DIAG_GPIO_CALLS,
+	DIAG_QUEUE_STORE, DIAG_QUEUE_DROPPED, DIAG_QUEUE_RECORDS
+};
+
+static aggregate_Window_t			_diagTickWindow;			//microseconds
+static aggregate_Window_t			_diagLatencyWindow;			//milliseconds
+static uint32_t						_diagPushOk = 0;
+static uint32_t						_diagPushFailed = 0;
+static uint32_t						_diagGpioCalls = 0;			//gpioService call count at the start of the period
+
+
+//elapsed time since the given time, in microseconds
+static double GetElapsedUs(le_clk_Time_t startTime)
+{
+	le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+	return (double)elapsed.sec * 1000000.0 + (double)elapsed.usec;
+}
+
+//current time, as a timeserie timestamp (UTC in milliseconds)
+static uint64_t GetUtcMilliSec()
+{
+	le_clk_Time_t now = le_clk_GetAbsoluteTime();
+
+	return (uint64_t)now.sec * 1000 + (uint64_t)now.usec / 1000;
+}
+
+//create the diagnostic variables
+void diag_Init()
+{
+	size_t i;
+
+	for (i = 0; i < NUM_ARRAY_MEMBERS(_diagPaths); i++)
+	{
+		le_avdata_CreateResource(_diagPaths[i], LE_AVDATA_ACCESS_VARIABLE);
+	}
+
+	aggregate_Reset(&_diagTickWindow);
+	aggregate_Reset(&_diagLatencyWindow);
+	_diagGpioCalls = gpio_iot_GetCallCount();
+}
+
+//a data generation tick has ended
+void diag_AddTick(le_clk_Time_t startTime)
+{
+	aggregate_Add(&_diagTickWindow, GetElapsedUs(startTime));
+}
+
+//the callback of a push has been called
+void diag_AddPush(le_clk_Time_t issueTime, bool bSuccess)
+{
+	aggregate_Add(&_diagLatencyWindow, GetElapsedUs(issueTime) / 1000.0);
+
+	if (bSuccess)
+	{
+		_diagPushOk++;
+	}
+	else
+	{
+		_diagPushFailed++;
+	}
+}
+
+//Callback of the diagnostic push
+static void DiagPushCallbackHandler
+(
+	le_avdata_PushStatus_t status,
+	void* contextPtr
+)
+{
+	if (status != LE_AVDATA_PUSH_SUCCESS)
+	{
+		LE_WARN("Failed to push diagnostics");
+	}
+
+	session_PushCompleted((uint32_t)(uintptr_t)contextPtr, status == LE_AVDATA_PUSH_SUCCESS);
+}
+
+//Periodic job : set the diagnostic variables and push them in one record, so that they can be charted
+void diag_Publish(void* contextPtr)
+{
+	double		dLatitude, dLongitude;
+	int32_t		hAccuracy, altitude, vAccuracy;
+	uint32_t	fixAge = 0;
+	uint32_t	gpioCalls = gpio_iot_GetCallCount();
+
+	int32_t		values[NUM_ARRAY_MEMBERS(_diagPaths)] =
+	{
+		(int32_t)aggregate_GetMean(&_diagTickWindow),
+		(int32_t)(_diagTickWindow.count ? _diagTickWindow.max : 0),
+		(int32_t)aggregate_GetMean(&_diagLatencyWindow),
+		(int32_t)(_diagLatencyWindow.count ? _diagLatencyWindow.max : 0),
+		(int32_t)_diagPushOk,
+		(int32_t)_diagPushFailed,
+		(int32_t)session_GetInFlight(),
+		(int32_t)session_GetStallCount(),
+		(POSITION_LOCATION_NO == position_GetLastLocation(&dLatitude, &dLongitude, &hAccuracy, &altitude, &vAccuracy, &fixAge)) ? -1 : (int32_t)fixAge,
+		uplink_GetSignalQuality(),
+		(int32_t)(gpioCalls - _diagGpioCalls),
+		(int32_t)store_GetCount(),
+		(int32_t)store_GetDropCount(),
+		(int32_t)record_GetLive()
+	};
+
+	size_t i;
+
+	for (i = 0; i < NUM_ARRAY_MEMBERS(_diagPaths); i++)
+	{
+		le_avdata_SetInt(_diagPaths[i], values[i]);
+	}
+
+	LE_DEBUG("Diag : tick %d/%d us, push %d/%d ms, %d ok, %d failed, %d in flight, fix age %d s, radio %d, %d gpio calls, %d stored",
+			values[0], values[1], values[2], values[3], values[4], values[5], values[6], values[8], values[9], values[10], values[11]);
+
+	//the variables can still be read while the uplink is busy, only the chart misses a point
+	if (session_CanPush())
+	{
+		le_avdata_RecordRef_t recordRef = record_Acquire();
+
+		if (recordRef)
+		{
+			uint64_t	timestamp = GetUtcMilliSec();
+			le_result_t	result = LE_OK;
+
+			for (i = 0; (i < NUM_ARRAY_MEMBERS(_diagPaths)) && (LE_OK == result); i++)
+			{
+				result = le_avdata_RecordInt(recordRef, _diagPaths[i], values[i], timestamp);
+			}
+
+			if (LE_OK == result)
+			{
+				result = le_avdata_PushRecord(recordRef, DiagPushCallbackHandler, (void*)(uintptr_t)session_GetEpoch());
+			}
+
+			if (LE_OK == result)
+			{
+				session_PushIssued();
+			}
+
+			record_Release(recordRef, false);
+		}
+	}
+
+	//new period
+	aggregate_Reset(&_diagTickWindow);
+	aggregate_Reset(&_diagLatencyWindow);
+	_diagPushOk = 0;
+	_diagPushFailed = 0;
+	_diagGpioCalls = gpioCalls;
+}
@@ -0,0 +1,27 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file diag.h
+ *
+ * Helper lib measuring the hot paths of the app, published as AirVantage diagnostic variables (truck.var.diag.*):
+ *      data generation tick duration, push latency (issue to callback), push outcomes,
+ *      GNSS fix age, GPIO calls to gpioService, and depth of the pending queues
+ *      Durations are summarized (mean, max) over the publication period, counts are per period
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _DIAG_H_
+#define _DIAG_H_
+
+//Call this function first to create the diagnostic variables
+void diag_Init();
+
+//A data generation tick started at startTime has just ended
+void diag_AddTick(le_clk_Time_t startTime);
+
+//The callback of a push issued at issueTime has been called
+void diag_AddPush(le_clk_Time_t issueTime, bool bSuccess);
+
+//Periodic job : publish the diagnostic variables, and start a new period
+void diag_Publish(void* contextPtr);
+
+#endif //_DIAG_H_
@@ -11,9 +11,26 @@
  *      When temperature reaches the 'target temperature', the fan automatically stops
  *      When the fan is stopped or truck door is opened, truck's temperature converges to the 'outside air temperature'
  *      The truck is posting the fan status (on/off) and door status (opened/closed) on a regular basis (interval.datapush) to AirVantage
- *      The current position of the truck is also pushed to AirVantage
+ *      The current position of the truck is also pushed to AirVantage, along with the timeserie data
  *      The truck is collecting the current temprature and fan duration on a regular basis (interval.datagen)
- *          this data is timestamped and is pushed to AirVantage as timeserie data (chunk of TIMESERIE_MAX_RECORD)
+ *          this data is timestamped and is pushed to AirVantage as timeserie data, in chunks filling up to
+ *          batch.bytes, or at least every batch.latency seconds
+ *      All periodic jobs share one timer, aligned so that jobs falling due together run in the same wakeup
+ *          samples which failed to be pushed are kept on flash, and replayed when the AirVantage session is back
+ *          by default, the samples are summarized per aggregate.window (min, max, mean, count, last) and only the
+ *          summaries are pushed, raw samples are pushed when aggregate.raw is set
+ *      While the AirVantage session is down, pushes are held and sent in one burst when it is back
+ *      Pushes waiting for their callback are capped (push.maxInFlight), new data is merged into the held data meanwhile
+ *      Tick duration, push latency & outcome, fix age, GPIO calls and queue depths are published every diag.interval (truck.var.diag.*)
+ *      The truck has zone.count independently cooled compartments (1-4), each with its own door, fan and target temperature :
+ *          their resources are indexed (truck.var.zone[N].temp.current), the state is kept in one array per field
+ *          and the simulation sweeps every compartment in one loop. Compartment 0 is wired to the IoT card
+ *      The temperature model is advanced by the time elapsed since its last update : a wakeup after a suspend catches up in one step
+ *      In low-power mode (power.low), GNSS is only active for a fix every power.fixInterval ; while the doors are closed and the
+ *          temperature is stable, the truck samples every power.sleepInterval only, and pushes everything in one burst per wakeup.
+ *          The door switch wakes it up right away
+ *      The hot path events are kept in an in-memory trace ring instead of being logged, it is formatted to the log
+ *          by the truck.cmd.dumpTrace command : only errors are logged otherwise
  *
  *    LED, motor & swicth, connected to IoT card (slot 0) of a mangOH board:
  *      a push button to open/close the truck door - [IoT0, GPIO_1]
@@ -25,7 +42,9 @@
  *      When the fan duration exceeds a limit then send an email to maintenance team
  *
  *    Operation team can perform the following actions on AirVantage:
- *      Send commands to truck to : Start/Stop Fan, Simulate Open/Close door
+ *      Send commands to a truck compartment to : Start/Stop Fan, Simulate Open/Close door
+ *      Alarms (door opened, temperature above temp.alarm, fan failure) are pushed right away, carrying the pending data along
+ *      Commands are acknowledged as soon as the actuator is driven, the state change is pushed right after
  *      Change truck settings, e.g. 'target temperature', 'outside air temperature', interval.datagen, interval.datapush
  *
  *  NC - March 2018
@@ -35,484 +54,2096 @@
 #include "legato.h"
 #include "interfaces.h"
 
+#include <math.h>
+
 #include "position.h"   //Use position helper lib to push the current location to AirVantage
 #include "gpio_iot.h"   //Use gpio_iot helper lib to manage the door LED, door switch and fan motor, connected to IoT card's GPIO pin (24, 25, 26)
+#include "store.h"      //Use store helper lib to keep the timeserie samples on flash until AirVantage got them
+#include "record.h"     //Use record helper lib to bound the number of timeserie records
+#include "session.h"    //Use session helper lib to share the AirVantage session and hold the pushes while it is down
+#include "scheduler.h"  //Use scheduler helper lib to run the periodic jobs from a single aligned timer
+#include "aggregate.h"  //Use aggregate helper lib to summarize the samples over a window
+#include "worker.h"     //Use worker helper lib to run the config tree commits off the main thread
+#include "uplink.h"     //Use uplink helper lib to hold the timeseries while the radio is poor
+#include "diag.h"		//Use diag helper lib to publish the hot path metrics (truck.var.diag.*)
+#include "thermal.h"	//Use thermal helper lib to simulate the temperature of the compartments
+#include "trace.h"		//Use trace helper lib to keep the hot path events in memory instead of logging them
 
 //Config tree path of settings for persistency
 #define CONFIG_DATAPUSH_INTERVAL			"/fridgeTruck/DataPushInterval"
 #define CONFIG_DATAGEN_INTERVAL				"/fridgeTruck/DataGenInterval"
 
 #define CONFIG_AIR_TEMPERATURE				"/fridgeTruck/OutsideTemperature"
-#define CONFIG_TARGET_TEMPERATURE			"/fridgeTruck/TargetTemperature"
+#define CONFIG_TARGET_TEMPERATURE			"/fridgeTruck/Zone%d/TargetTemperature"
+#define CONFIG_LEGACY_TARGET_TEMPERATURE	"/fridgeTruck/TargetTemperature"        //single compartment trucks, migrated to Zone0
+#define CONFIG_ALARM_TEMPERATURE			"/fridgeTruck/AlarmTemperature"
+
+#define CONFIG_REPORT_BY_EXCEPTION			"/fridgeTruck/ReportByException"
+#define CONFIG_TEMP_DEADBAND				"/fridgeTruck/TempDeadband"
+#define CONFIG_DURATION_DEADBAND			"/fridgeTruck/DurationDeadband"
+#define CONFIG_REPORT_HEARTBEAT				"/fridgeTruck/ReportHeartbeat"
+
+#define CONFIG_BATCH_BYTES					"/fridgeTruck/BatchBytes"
+#define CONFIG_BATCH_LATENCY				"/fridgeTruck/BatchLatency"
+
+#define CONFIG_GNSS_H_DISTANCE				"/fridgeTruck/GnssHDistance"
+#define CONFIG_GNSS_V_DISTANCE				"/fridgeTruck/GnssVDistance"
+
+#define CONFIG_AGGREGATE_WINDOW				"/fridgeTruck/AggregateWindow"
+#define CONFIG_AGGREGATE_RAW				"/fridgeTruck/AggregateRaw"
+
+#define CONFIG_MAX_IN_FLIGHT				"/fridgeTruck/MaxInFlight"
+
+#define CONFIG_DIAG_INTERVAL				"/fridgeTruck/DiagInterval"
+
+#define CONFIG_ZONE_COUNT					"/fridgeTruck/ZoneCount"
+
+#define CONFIG_LOW_POWER					"/fridgeTruck/LowPower"
+#define CONFIG_SLEEP_INTERVAL				"/fridgeTruck/SleepInterval"
+#define CONFIG_FIX_INTERVAL					"/fridgeTruck/FixInterval"
+
+#define CONFIG_UPLINK_MIN_QUALITY			"/fridgeTruck/UplinkMinQuality"
+#define CONFIG_UPLINK_MAX_DELAY				"/fridgeTruck/UplinkMaxDelay"
+
+#define CONFIG_SAVE_DELAY_MS				2000        //settings changed within this delay are committed together
+#define CONFIG_DRAIN_TIMEOUT_MS				1000        //max wait at exit for a commit queued on the worker
 
 //GPIO pins to be used on the IoT card
 #define GPIO_PIN_DOOR_SWITCH				1
 #define GPIO_PIN_DOOR_LED					2
 #define GPIO_PIN_FAN_MOTOR					3
+#define GPIO_ACTUATORS_MASK					(GPIO_IOT_MASK(GPIO_PIN_DOOR_LED) | GPIO_IOT_MASK(GPIO_PIN_FAN_MOTOR))
+
+//longest gap the thermal model is advanced by at once (seconds)
+#define THERMAL_MAX_ELAPSED_SEC				86400
+
+//time the door switch must be stable before a push is taken, the edges of a bouncing contact within it are coalesced
+#define DOOR_SWITCH_SETTLE_MS				50
+
+//Compartments of the truck, each one has its own door, fan and target temperature
+#define ZONE_MAX_COUNT						4
+#define ZONE_PATH_MAX						48          //fits the longest resource path or config path of a compartment
+
+//AV System Data Variables of a compartment, the path is a format taking the zone index
+#define VARIABLE_FAN_STATE      			"truck.var.zone[%d].fan.isOn"           //boolean : fan is on or off
+#define VARIABLE_FAN_DURATION   			"truck.var.zone[%d].fan.duration"       //int : how long it's been functioning (minute)
+#define VARIABLE_TEMP_CURRENT   			"truck.var.zone[%d].temp.current"       //float : current temperature
+#define VARIABLE_DOOR_STATE     			"truck.var.zone[%d].door.isOpen"        //boolean : door is opened or closed
+#define VARIABLE_TEMP_MIN					"truck.var.zone[%d].temp.min"           //float : min temperature of the last window (timeserie only)
+#define VARIABLE_TEMP_MAX					"truck.var.zone[%d].temp.max"           //float : max temperature of the last window (timeserie only)
+#define VARIABLE_TEMP_MEAN					"truck.var.zone[%d].temp.mean"          //float : mean temperature of the last window (timeserie only)
+#define VARIABLE_TEMP_COUNT					"truck.var.zone[%d].temp.count"         //int : samples in the last window (timeserie only)
+
+//AV System Data Variables of the truck
+#define VARIABLE_TEMP_ALARM					"truck.var.alarm.temp"              //boolean : temperature of a compartment is above the alarm limit
+#define VARIABLE_FAN_FAILURE				"truck.var.alarm.fan"               //boolean : fan motor cannot be driven
+#define VARIABLE_CMD_LATENCY				"truck.var.cmd.latency"             //int : time to drive the actuator of the last command (microseconds)
+
+//State of the compartments, one array per field : the simulation sweeps each field over every compartment
+static struct
+{
+	double									temperature[ZONE_MAX_COUNT];		//current temp
+	double									temperatureTarget[ZONE_MAX_COUNT];
+	int										fanDuration[ZONE_MAX_COUNT];
+	double									fanDurationRaw[ZONE_MAX_COUNT];		//fan duration with its fraction
+	bool									fanIsOn[ZONE_MAX_COUNT];
+	bool									doorIsOpen[ZONE_MAX_COUNT];
+} _zones;
+
+//The compartments, as seen by the thermal model
+static const thermal_Zones_t				_thermalZones =
+{
+	_zones.temperature, _zones.temperatureTarget, _zones.fanDuration, _zones.fanDurationRaw, _zones.fanIsOn, _zones.doorIsOpen
+};
+
+static double								_thermalTime;						//when the thermal model was last advanced (boot clock, seconds)
+static int									_zoneCount = 1;						//compartments in use
+static int									_zoneCreatedCount = 0;				//compartments whose resources are created
+static bool									_tempAlarm = false;
+static bool									_fanFailure = false;
+static int									_commandLatency = 0;
+
+//State variables pushed together as one record
+#define STATE_FAN							0x01
+#define STATE_DOOR							0x02
+#define STATE_TEMP_ALARM					0x04
+#define STATE_FAN_FAILURE					0x08
+#define STATE_ALL							(STATE_FAN | STATE_DOOR | STATE_TEMP_ALARM | STATE_FAN_FAILURE)
+#define STATE_PUSH_DELAY_MS					500         //state changes within this delay are pushed together
+#define TEMP_ALARM_HYSTERESIS				0.5         //the temperature alarm clears below the limit minus this margin
+
+
+//AV System Data Settings
+#define SETTING_TEMP_TARGET     			"truck.set.zone[%d].temp.target"    //float : target regulated temperature of a compartment
+#define SETTING_ZONE_COUNT					"truck.set.zone.count"              //int : compartments of the truck (1 - 4)
+#define SETTING_TEMP_AIR        			"truck.set.temp.outside"            //int : outside air temperature
+#define SETTING_TEMP_ALARM					"truck.set.temp.alarm"              //float : temperature above which an alarm is pushed right away
+#define SETTING_DATAGEN_INTERVAL 			"truck.set.interval.datagen"
+#define SETTING_DATAPUSH_INTERVAL			"truck.set.interval.datapush"
+#define SETTING_MANGOH_TYPE					"truck.set.mangohType"
+
+
+#define DEFAULT_TEMP_TARGET					2.2
+static double								_temperatureAlarm = 8.0;
+static int                      			_temperatureOutside = 27;
+static int									_dataGenInterval = 5;				//5 seconds
+static int									_dataPushInterval = 20;				//30 seconds
+#define SETTING_PERIOD_MAX					86400								//longest period of a scheduled job, 1 day
+static int									_mangohBoardType;                   //type of mangOH board (gpio_iot_mangohType_t : Red, Green)
+
+//Report-by-exception settings : booleans are reported on change, numeric values when they move out of their deadband
+#define SETTING_REPORT_ENABLE				"truck.set.report.enable"			//bool : report by exception instead of on every tick
+#define SETTING_TEMP_DEADBAND				"truck.set.report.tempDeadband"		//float : min temperature change to be reported (°C)
+#define SETTING_DURATION_DEADBAND			"truck.set.report.durationDeadband"	//int : min fan duration change to be reported
+#define SETTING_REPORT_HEARTBEAT			"truck.set.report.heartbeat"		//int : max silence before everything is reported anyway (seconds)
+
+
+static bool									_reportByException = false;
+static double								_tempDeadband = 0.5;
+static int									_durationDeadband = 10;
+static int									_reportHeartbeat = 300;				//5 minutes
+
+//Last reported values, for report-by-exception
+static uint32_t								_reportedState = 0;					//STATE_xxx reported at least once
+static uint32_t								_pendingState = 0;					//STATE_xxx queued, or held while the session was down
+static uint32_t								_statePushesInFlight = 0;			//state pushes waiting for their callback in this session
+static le_timer_Ref_t						_statePushTimerRef = NULL;			//coalesces the state changes into one push
+static bool									_alarmPushQueued = false;			//an alarm push is queued to the event loop
+static struct
+{
+	bool									fanIsOn[ZONE_MAX_COUNT];
+	bool									doorIsOpen[ZONE_MAX_COUNT];
+	double									temperature[ZONE_MAX_COUNT];
+	int										fanDuration[ZONE_MAX_COUNT];
+} _reportedZones;
+static bool									_reportedTempAlarm;
+static bool									_reportedFanFailure;
+static time_t								_stateReportTime = 0;
+static bool									_samplesReported = false;
+static time_t								_samplesReportTime = 0;
+
+//Timeserie batching settings : a record is pushed when it fills the byte budget, or when its oldest sample reaches the max latency
+#define SETTING_BATCH_BYTES					"truck.set.batch.bytes"				//int : payload budget of a timeserie push (bytes)
+#define SETTING_BATCH_LATENCY				"truck.set.batch.latency"			//int : max age of a sample before the timeserie is pushed (seconds)
+
+
+static int									_batchBytes = 1024;					//fits a CoAP block
+static int									_batchLatency = 120;				//2 minutes
+
+//GNSS settings : the location is only refreshed when the truck moved more than these distances
+#define SETTING_GNSS_H_DISTANCE				"truck.set.gnss.hDistance"			//int : horizontal distance (meters)
+#define SETTING_GNSS_V_DISTANCE				"truck.set.gnss.vDistance"			//int : vertical distance (meters)
+
+
+static int									_gnssHDistance = 50;
+static int									_gnssVDistance = 50;
+
+//Aggregation settings : the samples are summarized per window, unless raw samples are requested
+#define SETTING_AGGREGATE_WINDOW			"truck.set.aggregate.window"		//int : length of a summary window (seconds)
+#define SETTING_AGGREGATE_RAW				"truck.set.aggregate.raw"			//bool : push every raw sample instead of the summaries
+
+static int									_aggregateWindow = 60;				//1 minute
+static bool									_aggregateRaw = false;
+
+//Backpressure setting : once this many pushes wait for their callback, new data is held and merged into the pending batch
+#define SETTING_MAX_IN_FLIGHT				"truck.set.push.maxInFlight"		//int : max pushes in flight
+
+static int									_maxInFlight = 4;
+
+//Diagnostics setting
+#define SETTING_DIAG_INTERVAL				"truck.set.diag.interval"			//int : period of the diagnostic variables (seconds), 0 = disabled
+
+static int									_diagInterval = 300;				//5 minutes
+
+//Low-power settings : GNSS is only active for a fix every fixInterval, and while the door is closed and the temperature is stable
+//the truck sleeps between 2 samples taken every sleepInterval, the door switch wakes it up right away
+#define SETTING_LOW_POWER					"truck.set.power.low"				//bool : low-power mode, for parked trailers
+#define SETTING_SLEEP_INTERVAL				"truck.set.power.sleepInterval"		//int : time between 2 samples while asleep (seconds)
+#define SETTING_FIX_INTERVAL				"truck.set.power.fixInterval"		//int : time between 2 fixes (seconds)
+
+static bool									_lowPower = false;
+static int									_sleepInterval = 300;				//5 minutes
+static int									_fixInterval = 900;					//15 minutes
+static bool									_sleeping = false;					//door closed and temperature stable, in low-power mode
+
+//Uplink settings : while the signal quality is below minQuality, timeseries and replays are held, for maxDelay at most
+#define SETTING_UPLINK_MIN_QUALITY			"truck.set.uplink.minQuality"		//int : le_mrc signal quality (0-5) needed to upload, 0 : whatever the radio
+#define SETTING_UPLINK_MAX_DELAY			"truck.set.uplink.maxDelay"			//int : max age of a held sample (seconds), 0 : until the radio improves
+
+static int									_uplinkMinQuality = 2;
+static int									_uplinkMaxDelay = 900;				//15 minutes
+
+//AV Commands of a compartment
+#define COMMAND_FAN_START       			"truck.cmd.zone[%d].startFan"       //Start fan
+#define COMMAND_FAN_STOP        			"truck.cmd.zone[%d].stopFan"        //Stop fan
+#define COMMAND_OPEN_DOOR       			"truck.cmd.zone[%d].openDoor"       //Open door
+#define COMMAND_CLOSE_DOOR        			"truck.cmd.zone[%d].closeDoor"      //Close door
+
+//AV Commands of the truck
+#define COMMAND_DUMP_TRACE					"truck.cmd.dumpTrace"				//Format the trace of the hot path events to the log
+
+//Default behavior
+#define DEFAULT_START_TEMP 					5.2         //default starting point of the current temperature
+#define DEFAULT_INITIAL_TEMP				4.2         //current temperature when the outside temperature is unknown
+//Estimated encoded size of a timeserie (CBOR) : resource names once in the header, then timestamp and values per sample
+#define TIMESERIE_HEADER_BYTES				16
+#define TIMESERIE_ZONE_HEADER_BYTES			(sizeof(VARIABLE_TEMP_CURRENT) + sizeof(VARIABLE_FAN_DURATION))
+#define TIMESERIE_TIMESTAMP_BYTES			9
+#define TIMESERIE_FLOAT_BYTES				9
+#define TIMESERIE_INT_BYTES					5
+#define TIMESERIE_LOCATION_BYTES			(4 * (sizeof("lwm2m.6.0.0") + TIMESERIE_FLOAT_BYTES))
+#define TIMESERIE_MAX_SAMPLES				128         //max values kept aside for a timeserie until its push is acknowledged
+#define TIMESERIE_MAX_TICK_SAMPLES			(SAMPLE_KIND_COUNT * ZONE_MAX_COUNT)    //max values recorded at once (a window summary of every compartment)
+
+//Store-and-forward of the timeserie samples which failed to be pushed
+#define SAMPLE_STORE_PATH					"/home/root/fridgeTruck.store"
+#define SAMPLE_STORE_CAPACITY				8192        //samples kept on flash (32 bytes each)
+#define REPLAY_MAX_SAMPLES					512         //samples replayed per push
+#define REPLAY_INTERVAL						10          //seconds between 2 replay pushes, not to flood the link on reconnection
+
+//resource ids of the samples kept in the store : kind of sample, per compartment
+#define SAMPLE_TEMP_CURRENT					0
+#define SAMPLE_FAN_DURATION					1
+#define SAMPLE_TEMP_MIN						2
+#define SAMPLE_TEMP_MAX						3
+#define SAMPLE_TEMP_MEAN					4
+#define SAMPLE_TEMP_COUNT					5
+#define SAMPLE_KIND_COUNT					6
+#define SAMPLE_ID(zone, kind)				((zone) * SAMPLE_KIND_COUNT + (kind))
+
+
+//Other
+static scheduler_JobRef_t					_dataGenJobRef = NULL;                //reference to data generation/simulation job
+static scheduler_JobRef_t					_dataPushJobRef = NULL;               //reference to push data job
+static scheduler_JobRef_t					_flushJobRef = NULL;                  //reference to timeserie flush job, every batch.latency
+static scheduler_JobRef_t					_diagJobRef = NULL;                   //reference to diagnostics job, every diag.interval
+static scheduler_JobRef_t					_aggregateJobRef = NULL;              //reference to window summary job, every aggregate.window
+static aggregate_Window_t					_temperatureWindows[ZONE_MAX_COUNT];  //temperature samples of the current window, per compartment
+static aggregate_Window_t					_fanDurationWindows[ZONE_MAX_COUNT];  //fan duration samples of the current window, per compartment
+static le_avdata_RecordRef_t 				_recordRef = NULL;                    //reference to the timeserie data
+static int 									_recordCount = 0;                     //timeserie record counter
+static size_t								_recordBytes = 0;                     //estimated encoded size of the timeserie
+
+//samples of a timeserie, kept until its push is acknowledged
+typedef struct TimeserieBatch
+{
+	struct TimeserieBatch*	nextPtr;			//next batch waiting for its push callback
+	uint32_t				id;					//given to the push callback, which finds the batch back by it
+	uint32_t				epoch;				//session epoch of the push
+	size_t					count;
+	store_Sample_t			samples[TIMESERIE_MAX_SAMPLES];
+} TimeserieBatch_t;
+
+static le_mem_PoolRef_t						_batchPool = NULL;
+static bool									_storeOpened = false;                 //the samples not delivered can be kept on flash
+static TimeserieBatch_t*					_batchPtr = NULL;                     //samples of _recordRef
+static TimeserieBatch_t*					_batchesInFlight = NULL;              //pushed batches, waiting for their callback
+static uint32_t								_batchId = 0;                         //id of the last pushed batch
+
+static scheduler_JobRef_t					_replayJobRef = NULL;                 //paces the replay of the stored samples
+static bool									_replayActive = false;                //replay job is running
+static bool									_replayInFlight = false;
+static uint32_t								_replayNextSeq = 0;                   //acked once the replay in flight is delivered
+static store_Sample_t						_replaySamples[REPLAY_MAX_SAMPLES];
+
+static le_timer_Ref_t						_saveConfigTimerRef = NULL;           //defers the config tree commit
+
+//Resource table : each AirVantage resource, its typed storage and its handler, bound to le_avdata through the contextPtr
+typedef enum
+{
+	RESOURCE_TYPE_NONE,				//command
+	RESOURCE_TYPE_INT,
+	RESOURCE_TYPE_FLOAT,
+	RESOURCE_TYPE_BOOL				//persisted as an int
+} ResourceType_t;
+
+typedef struct
+{
+	const char*				pathPtr;			//AirVantage path
+	le_avdata_AccessMode_t	accessMode;
+	ResourceType_t			type;
+	void*					valuePtr;			//int*, double* or bool*, its initial value is the default
+	const char*				configPathPtr;		//config tree path of a persisted setting, NULL if not persisted
+	void					(*handlerPtr)(int zone);	//called once a setting changed, or to execute a command
+	int						zone;				//compartment of the resource, 0 for the truck resources
+	int						minValue;			//range of an int setting, a value out of it is rejected
+	int						maxValue;			//not checked if both are 0
+} Resource_t;
+
+//Resource of a compartment : the paths are formats taking the zone index, the storage is a field array of _zones
+typedef struct
+{
+	const char*				pathFormatPtr;
+	le_avdata_AccessMode_t	accessMode;
+	ResourceType_t			type;
+	void*					arrayPtr;			//int[], double[] or bool[], NULL for a command
+	size_t					elementSize;
+	const char*				configFormatPtr;	//NULL if not persisted
+	void					(*handlerPtr)(int zone);
+} ZoneResource_t;
+
+static void PushTimeserie();
+static void SummarizeWindow(void* contextPtr);
+static void ApplyAggregation(int zone);
+static void ApplyMaxInFlight(int zone);
+static void ApplyJobPeriods(int zone);
+static void ApplyLowPower(int zone);
+static void ApplyUplink(int zone);
+static void ApplyMangohType(int zone);
+static void ApplyGnssThresholds(int zone);
+static void ApplyZoneCount(int zone);
+static void StartFan(int zone);
+static void StopFan(int zone);
+static void OpenDoor(int zone);
+static void CloseDoor(int zone);
+static void DumpTrace(int zone);
+
+static const Resource_t						_resources[] =
+{
+	//Variables
+	{ .pathPtr = VARIABLE_TEMP_ALARM,				.accessMode = LE_AVDATA_ACCESS_VARIABLE,	.type = RESOURCE_TYPE_BOOL,		.valuePtr = &_tempAlarm,				.configPathPtr = NULL,								.handlerPtr = NULL,							.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = VARIABLE_FAN_FAILURE,				.accessMode = LE_AVDATA_ACCESS_VARIABLE,	.type = RESOURCE_TYPE_BOOL,		.valuePtr = &_fanFailure,				.configPathPtr = NULL,								.handlerPtr = NULL,							.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = VARIABLE_CMD_LATENCY,				.accessMode = LE_AVDATA_ACCESS_VARIABLE,	.type = RESOURCE_TYPE_INT,		.valuePtr = &_commandLatency,			.configPathPtr = NULL,								.handlerPtr = NULL,							.zone = 0,	.minValue = 0,	.maxValue = 0 },
+
+	//Settings
+	{ .pathPtr = SETTING_DATAGEN_INTERVAL,			.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_dataGenInterval,			.configPathPtr = CONFIG_DATAGEN_INTERVAL,			.handlerPtr = ApplyJobPeriods,				.zone = 0,	.minValue = 1,	.maxValue = SETTING_PERIOD_MAX },
+	{ .pathPtr = SETTING_DATAPUSH_INTERVAL,			.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_dataPushInterval,			.configPathPtr = CONFIG_DATAPUSH_INTERVAL,			.handlerPtr = ApplyJobPeriods,				.zone = 0,	.minValue = 1,	.maxValue = SETTING_PERIOD_MAX },
+	{ .pathPtr = SETTING_TEMP_ALARM,				.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_FLOAT,	.valuePtr = &_temperatureAlarm,			.configPathPtr = CONFIG_ALARM_TEMPERATURE,			.handlerPtr = NULL,							.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_TEMP_AIR,					.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_temperatureOutside,		.configPathPtr = CONFIG_AIR_TEMPERATURE,			.handlerPtr = NULL,							.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_MANGOH_TYPE,				.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_mangohBoardType,			.configPathPtr = NULL,								.handlerPtr = ApplyMangohType,				.zone = 0,	.minValue = GPIO_IOT_MANGOH_RED,	.maxValue = GPIO_IOT_MANGOH_YELLOW },		//persisted by the gpio helper lib
+	{ .pathPtr = SETTING_REPORT_ENABLE,				.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_BOOL,		.valuePtr = &_reportByException,		.configPathPtr = CONFIG_REPORT_BY_EXCEPTION,		.handlerPtr = NULL,							.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_TEMP_DEADBAND,				.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_FLOAT,	.valuePtr = &_tempDeadband,				.configPathPtr = CONFIG_TEMP_DEADBAND,				.handlerPtr = NULL,							.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_DURATION_DEADBAND,			.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_durationDeadband,			.configPathPtr = CONFIG_DURATION_DEADBAND,			.handlerPtr = NULL,							.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_REPORT_HEARTBEAT,			.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_reportHeartbeat,			.configPathPtr = CONFIG_REPORT_HEARTBEAT,			.handlerPtr = NULL,							.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_BATCH_BYTES,				.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_batchBytes,				.configPathPtr = CONFIG_BATCH_BYTES,				.handlerPtr = NULL,							.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_BATCH_LATENCY,				.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_batchLatency,				.configPathPtr = CONFIG_BATCH_LATENCY,				.handlerPtr = ApplyJobPeriods,				.zone = 0,	.minValue = 1,	.maxValue = SETTING_PERIOD_MAX },
+	{ .pathPtr = SETTING_GNSS_H_DISTANCE,			.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_gnssHDistance,			.configPathPtr = CONFIG_GNSS_H_DISTANCE,			.handlerPtr = ApplyGnssThresholds,			.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_GNSS_V_DISTANCE,			.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_gnssVDistance,			.configPathPtr = CONFIG_GNSS_V_DISTANCE,			.handlerPtr = ApplyGnssThresholds,			.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_AGGREGATE_WINDOW,			.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_aggregateWindow,			.configPathPtr = CONFIG_AGGREGATE_WINDOW,			.handlerPtr = ApplyAggregation,				.zone = 0,	.minValue = 1,	.maxValue = SETTING_PERIOD_MAX },
+	{ .pathPtr = SETTING_AGGREGATE_RAW,				.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_BOOL,		.valuePtr = &_aggregateRaw,				.configPathPtr = CONFIG_AGGREGATE_RAW,				.handlerPtr = ApplyAggregation,				.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_MAX_IN_FLIGHT,				.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_maxInFlight,				.configPathPtr = CONFIG_MAX_IN_FLIGHT,				.handlerPtr = ApplyMaxInFlight,				.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_DIAG_INTERVAL,				.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_diagInterval,				.configPathPtr = CONFIG_DIAG_INTERVAL,				.handlerPtr = ApplyJobPeriods,				.zone = 0,	.minValue = 0,	.maxValue = SETTING_PERIOD_MAX },
+	{ .pathPtr = SETTING_ZONE_COUNT,				.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_zoneCount,				.configPathPtr = CONFIG_ZONE_COUNT,					.handlerPtr = ApplyZoneCount,				.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_LOW_POWER,					.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_BOOL,		.valuePtr = &_lowPower,					.configPathPtr = CONFIG_LOW_POWER,					.handlerPtr = ApplyLowPower,				.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_SLEEP_INTERVAL,			.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_sleepInterval,			.configPathPtr = CONFIG_SLEEP_INTERVAL,				.handlerPtr = ApplyJobPeriods,				.zone = 0,	.minValue = 1,	.maxValue = SETTING_PERIOD_MAX },
+	{ .pathPtr = SETTING_FIX_INTERVAL,				.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_fixInterval,				.configPathPtr = CONFIG_FIX_INTERVAL,				.handlerPtr = ApplyLowPower,				.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_UPLINK_MIN_QUALITY,		.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_uplinkMinQuality,			.configPathPtr = CONFIG_UPLINK_MIN_QUALITY,			.handlerPtr = ApplyUplink,					.zone = 0,	.minValue = 0,	.maxValue = 0 },
+	{ .pathPtr = SETTING_UPLINK_MAX_DELAY,			.accessMode = LE_AVDATA_ACCESS_SETTING,		.type = RESOURCE_TYPE_INT,		.valuePtr = &_uplinkMaxDelay,			.configPathPtr = CONFIG_UPLINK_MAX_DELAY,			.handlerPtr = ApplyUplink,					.zone = 0,	.minValue = 0,	.maxValue = 0 },
+
+	//Commands
+	{ .pathPtr = COMMAND_DUMP_TRACE,				.accessMode = LE_AVDATA_ACCESS_COMMAND,		.type = RESOURCE_TYPE_NONE,		.valuePtr = NULL,						.configPathPtr = NULL,								.handlerPtr = DumpTrace,					.zone = 0,	.minValue = 0,	.maxValue = 0 },
+};
+
+//Resources of each compartment, the state variables are addressed by their index
+#define ZONE_RES_FAN_STATE					0
+#define ZONE_RES_DOOR_STATE					1
+
+static const ZoneResource_t					_zoneResourceTemplates[] =
+{
+	//Variables
+	[ZONE_RES_FAN_STATE] =
+	{ VARIABLE_FAN_STATE,			LE_AVDATA_ACCESS_VARIABLE,	RESOURCE_TYPE_BOOL,		_zones.fanIsOn,				sizeof(bool),	NULL,						NULL },
+	[ZONE_RES_DOOR_STATE] =
+	{ VARIABLE_DOOR_STATE,			LE_AVDATA_ACCESS_VARIABLE,	RESOURCE_TYPE_BOOL,		_zones.doorIsOpen,			sizeof(bool),	NULL,						NULL },
+	{ VARIABLE_FAN_DURATION,		LE_AVDATA_ACCESS_VARIABLE,	RESOURCE_TYPE_INT,		_zones.fanDuration,			sizeof(int),	NULL,						NULL },
+	{ VARIABLE_TEMP_CURRENT,		LE_AVDATA_ACCESS_VARIABLE,	RESOURCE_TYPE_FLOAT,	_zones.temperature,			sizeof(double),	NULL,						NULL },
+
+	//Settings
+	{ SETTING_TEMP_TARGET,			LE_AVDATA_ACCESS_SETTING,	RESOURCE_TYPE_FLOAT,	_zones.temperatureTarget,	sizeof(double),	CONFIG_TARGET_TEMPERATURE,	NULL },
+
+	//Commands
+	{ COMMAND_FAN_START,			LE_AVDATA_ACCESS_COMMAND,	RESOURCE_TYPE_NONE,		NULL,						0,				NULL,						StartFan },
+	{ COMMAND_FAN_STOP,				LE_AVDATA_ACCESS_COMMAND,	RESOURCE_TYPE_NONE,		NULL,						0,				NULL,						StopFan },
+	{ COMMAND_OPEN_DOOR,			LE_AVDATA_ACCESS_COMMAND,	RESOURCE_TYPE_NONE,		NULL,						0,				NULL,						OpenDoor },
+	{ COMMAND_CLOSE_DOOR,			LE_AVDATA_ACCESS_COMMAND,	RESOURCE_TYPE_NONE,		NULL,						0,				NULL,						CloseDoor },
+};
+
+#define ZONE_RESOURCE_COUNT					NUM_ARRAY_MEMBERS(_zoneResourceTemplates)
+
+//Resources of each compartment, built from the templates
+static Resource_t							_zoneResources[ZONE_MAX_COUNT][ZONE_RESOURCE_COUNT];
+static char									_zonePaths[ZONE_MAX_COUNT][ZONE_RESOURCE_COUNT][ZONE_PATH_MAX];
+static char									_zoneConfigPaths[ZONE_MAX_COUNT][ZONE_RESOURCE_COUNT][ZONE_PATH_MAX];
+
+//Copy of the persisted settings, committed to config tree by the worker thread
+typedef struct
+{
+	const char*				configPathPtr;
+	ResourceType_t			type;
+	union
+	{
+		int					i;
+		double				f;
+		bool				b;
+	} value;
+} ConfigSnapshotEntry_t;
+
+typedef struct
+{
+	size_t					count;
+	ConfigSnapshotEntry_t	entries[NUM_ARRAY_MEMBERS(_resources) + ZONE_MAX_COUNT * ZONE_RESOURCE_COUNT];
+	gpio_iot_mangohType_t	mangohType;
+} ConfigSnapshot_t;
+
+static ConfigSnapshot_t						_configSnapshot;
+static bool									_configCommitPending = false;         //_configSnapshot is being committed by the worker
+
+//Timeserie paths of each compartment, indexed by the kind of sample (SAMPLE_xxx)
+static const char*							_sampleFormats[SAMPLE_KIND_COUNT] =
+{
+	[SAMPLE_TEMP_CURRENT] = VARIABLE_TEMP_CURRENT,
+	[SAMPLE_FAN_DURATION] = VARIABLE_FAN_DURATION,
+	[SAMPLE_TEMP_MIN] = VARIABLE_TEMP_MIN,
+	[SAMPLE_TEMP_MAX] = VARIABLE_TEMP_MAX,
+	[SAMPLE_TEMP_MEAN] = VARIABLE_TEMP_MEAN,
+	[SAMPLE_TEMP_COUNT] = VARIABLE_TEMP_COUNT,
+};
+
+static char									_samplePaths[ZONE_MAX_COUNT][SAMPLE_KIND_COUNT][ZONE_PATH_MAX];
+
+
+//Set the initial state of every compartment, and build their resources and timeserie paths from the templates
+static void InitZones()
+{
+	int		zone;
+	size_t	i;
+
+	for (zone = 0; zone < ZONE_MAX_COUNT; zone++)
+	{
+		_zones.temperature[zone] = DEFAULT_INITIAL_TEMP;
+		_zones.temperatureTarget[zone] = DEFAULT_TEMP_TARGET;
+		thermal_ResetFanDuration(&_thermalZones, zone);
+		_zones.fanIsOn[zone] = true;
+		_zones.doorIsOpen[zone] = false;
+
+		aggregate_Reset(&_temperatureWindows[zone]);
+		aggregate_Reset(&_fanDurationWindows[zone]);
+
+		for (i = 0; i < ZONE_RESOURCE_COUNT; i++)
+		{
+			const ZoneResource_t*	templatePtr = &_zoneResourceTemplates[i];
+			Resource_t*				resPtr = &_zoneResources[zone][i];
+
+			snprintf(_zonePaths[zone][i], ZONE_PATH_MAX, templatePtr->pathFormatPtr, zone);
+
+			resPtr->pathPtr = _zonePaths[zone][i];
+			resPtr->accessMode = templatePtr->accessMode;
+			resPtr->type = templatePtr->type;
+			resPtr->valuePtr = templatePtr->arrayPtr ? (char*)templatePtr->arrayPtr + zone * templatePtr->elementSize : NULL;
+			resPtr->configPathPtr = NULL;
+			resPtr->handlerPtr = templatePtr->handlerPtr;
+			resPtr->zone = zone;
+			resPtr->minValue = 0;
+			resPtr->maxValue = 0;
+
+			if (templatePtr->configFormatPtr)
+			{
+				snprintf(_zoneConfigPaths[zone][i], ZONE_PATH_MAX, templatePtr->configFormatPtr, zone);
+				resPtr->configPathPtr = _zoneConfigPaths[zone][i];
+			}
+		}
+
+		for (i = 0; i < SAMPLE_KIND_COUNT; i++)
+		{
+			snprintf(_samplePaths[zone][i], ZONE_PATH_MAX, _sampleFormats[i], zone);
+		}
+	}
+}
+
+//Number of resources : the truck resources, then the resources of every compartment
+static size_t GetResourceCount()
+{
+	return NUM_ARRAY_MEMBERS(_resources) + ZONE_MAX_COUNT * ZONE_RESOURCE_COUNT;
+}
+
+//Resource at the given index, see GetResourceCount()
+static const Resource_t* GetResource(size_t index)
+{
+	if (index < NUM_ARRAY_MEMBERS(_resources))
+	{
+		return &_resources[index];
+	}
+
+	index -= NUM_ARRAY_MEMBERS(_resources);
+
+	return &_zoneResources[index / ZONE_RESOURCE_COUNT][index % ZONE_RESOURCE_COUNT];
+}
+
+
+// Write a persisted setting in a write transaction
+static void WriteConfigEntry(le_cfg_IteratorRef_t txnRef, const char* configPathPtr, ResourceType_t type, const void* valuePtr)
+{
+	switch (type)
+	{
+		case RESOURCE_TYPE_INT:
+			le_cfg_SetInt(txnRef, configPathPtr, *(const int*)valuePtr);
+			break;
+
+		case RESOURCE_TYPE_FLOAT:
+			le_cfg_SetFloat(txnRef, configPathPtr, *(const double*)valuePtr);
+			break;
+
+		case RESOURCE_TYPE_BOOL:
+			le_cfg_SetInt(txnRef, configPathPtr, *(const bool*)valuePtr);
+			break;
+
+		default:
+			break;
+	}
+}
+
+// Check an int setting against the range of its resource
+static bool IsInRange(const Resource_t* resPtr, int value)
+{
+	if ((resPtr->minValue == 0) && (resPtr->maxValue == 0))
+	{
+		return true;
+	}
+
+	return (value >= resPtr->minValue) && (value <= resPtr->maxValue);
+}
+
+// Read a persisted setting in a read transaction, false if it is missing (the default value is kept)
+static bool ReadConfigEntry(le_cfg_IteratorRef_t txnRef, const Resource_t* resPtr)
+{
+	if (!le_cfg_NodeExists(txnRef, resPtr->configPathPtr))
+	{
+		return false;
+	}
+
+	switch (resPtr->type)
+	{
+		case RESOURCE_TYPE_INT:
+		{
+			int value = le_cfg_GetInt(txnRef, resPtr->configPathPtr, *(int*)resPtr->valuePtr);
+
+			if (!IsInRange(resPtr, value))
+			{
+				LE_WARN("%s is %d, out of %d..%d : default %d kept", resPtr->configPathPtr, value,
+						resPtr->minValue, resPtr->maxValue, *(int*)resPtr->valuePtr);
+				return false;
+			}
+
+			*(int*)resPtr->valuePtr = value;
+			LE_INFO("%s is %d", resPtr->configPathPtr, *(int*)resPtr->valuePtr);
+			break;
+		}
+
+		case RESOURCE_TYPE_FLOAT:
+			*(double*)resPtr->valuePtr = le_cfg_GetFloat(txnRef, resPtr->configPathPtr, *(double*)resPtr->valuePtr);
+			LE_INFO("%s is %f", resPtr->configPathPtr, *(double*)resPtr->valuePtr);
+			break;
+
+		case RESOURCE_TYPE_BOOL:
+			*(bool*)resPtr->valuePtr = (le_cfg_GetInt(txnRef, resPtr->configPathPtr, *(bool*)resPtr->valuePtr) != 0);
+			LE_INFO("%s is %s", resPtr->configPathPtr, *(bool*)resPtr->valuePtr ? "true" : "false");
+			break;
+
+		default:
+			break;
+	}
+
+	return true;
+}
+
+// Copy the persisted settings, so that they can be committed by the worker while the app goes on changing them
+static void TakeConfigSnapshot(ConfigSnapshot_t* snapshotPtr)
+{
+	size_t i;
+
+	snapshotPtr->count = 0;
+
+	for (i = 0; i < GetResourceCount(); i++)
+	{
+		const Resource_t* resPtr = GetResource(i);
+
+		if (resPtr->configPathPtr)
+		{
+			ConfigSnapshotEntry_t* entryPtr = &snapshotPtr->entries[snapshotPtr->count++];
+
+			entryPtr->configPathPtr = resPtr->configPathPtr;
+			entryPtr->type = resPtr->type;
+
+			switch (resPtr->type)
+			{
+				case RESOURCE_TYPE_INT:		entryPtr->value.i = *(int*)resPtr->valuePtr;		break;
+				case RESOURCE_TYPE_FLOAT:	entryPtr->value.f = *(double*)resPtr->valuePtr;		break;
+				case RESOURCE_TYPE_BOOL:	entryPtr->value.b = *(bool*)resPtr->valuePtr;		break;
+				default:																		break;
+			}
+		}
+	}
+
+	snapshotPtr->mangohType = gpio_iot_GetMangohType();
+}
+
+// Commit a snapshot of the settings to config tree, all of them in a single transaction : on the worker thread, or on the main one at exit
+static void CommitConfig(void* contextPtr)
+{
+	const ConfigSnapshot_t*	snapshotPtr = (const ConfigSnapshot_t*)contextPtr;
+	le_cfg_IteratorRef_t	txnRef = le_cfg_CreateWriteTxn("/");
+	size_t					i;
+
+	for (i = 0; i < snapshotPtr->count; i++)
+	{
+		WriteConfigEntry(txnRef, snapshotPtr->entries[i].configPathPtr, snapshotPtr->entries[i].type, &snapshotPtr->entries[i].value);
+	}
+
+	//the board type of the gpio helper lib goes in the same commit
+	gpio_iot_WriteConfig(txnRef, snapshotPtr->mangohType);
+
+	le_cfg_CommitTxn(txnRef);
+}
+
+// Commit done by the worker, back on the main thread
+static void OnConfigCommitted(void* contextPtr)
+{
+	_configCommitPending = false;
+
+	LE_INFO("Settings saved to config tree");
+}
+
+// Save timer expiry : commit the settings changed since the timer was armed, off the main thread
+static void OnSaveConfigTimer(le_timer_Ref_t timerRef)
+{
+	if (_configCommitPending)
+	{
+		//the snapshot is still being committed, the changes since go in the next commit
+		le_timer_Start(timerRef);
+		return;
+	}
+
+	TakeConfigSnapshot(&_configSnapshot);
+	_configCommitPending = true;
+	worker_Submit(CommitConfig, OnConfigCommitted, &_configSnapshot);
+}
+
+// Save current settings to config tree : the commit is deferred, so that a burst of setting changes ends up in one commit
+void SaveConfig()
+{
+	if (NULL == _saveConfigTimerRef)
+	{
+		_saveConfigTimerRef = le_timer_Create("saveConfigTimer");
+		le_timer_SetMsInterval(_saveConfigTimerRef, CONFIG_SAVE_DELAY_MS);
+		le_timer_SetHandler(_saveConfigTimerRef, OnSaveConfigTimer);
+	}
+
+	//not restarted by later changes, a steady flow of changes is still committed every CONFIG_SAVE_DELAY_MS
+	if (!le_timer_IsRunning(_saveConfigTimerRef))
+	{
+		le_timer_Start(_saveConfigTimerRef);
+	}
+}
+
+// Commit the pending settings right away, if any
+static void FlushConfig()
+{
+	bool pending = _saveConfigTimerRef && le_timer_IsRunning(_saveConfigTimerRef);
+
+	if (_configCommitPending)
+	{
+		//a commit queued on the worker must not land after the final one
+		le_result_t result = worker_Drain(CONFIG_DRAIN_TIMEOUT_MS);
+
+		LE_WARN_IF(LE_OK != result, "Settings commit of the worker not drained (%d)", result);
+		pending = true;
+	}
+
+	if (pending)
+	{
+		//the app is exiting, the worker may not get to run : committed on the calling thread
+		ConfigSnapshot_t snapshot;
+
+		if (_saveConfigTimerRef)
+		{
+			le_timer_Stop(_saveConfigTimerRef);
+		}
+		TakeConfigSnapshot(&snapshot);
+		CommitConfig(&snapshot);
+
+		LE_INFO("Settings saved to config tree");
+	}
+}
+
+
+// Load parameters from config tree : every persisted setting in a single read transaction,
+// then only the missing ones are written back with their default value
+void LoadConfig()
+{
+	bool					missing[NUM_ARRAY_MEMBERS(_resources) + ZONE_MAX_COUNT * ZONE_RESOURCE_COUNT] = { false };
+	size_t					missingCount = 0;
+	bool					legacyTarget = false;
+	size_t					i;
+	int						zone;
+
+	le_cfg_IteratorRef_t	txnRef = le_cfg_CreateReadTxn("/");
+
+	for (i = 0; i < GetResourceCount(); i++)
+	{
+		if (NULL == GetResource(i)->configPathPtr)
+		{
+			continue;
+		}
+
+		missing[i] = !ReadConfigEntry(txnRef, GetResource(i));
+		missingCount += missing[i];
+
+		if (missing[i] && (GetResource(i)->valuePtr == &_zones.temperatureTarget[0])
+			&& le_cfg_NodeExists(txnRef, CONFIG_LEGACY_TARGET_TEMPERATURE))
+		{
+			//a truck upgraded from a single compartment keeps its target for compartment 0, the key is migrated below
+			_zones.temperatureTarget[0] = le_cfg_GetFloat(txnRef, CONFIG_LEGACY_TARGET_TEMPERATURE, _zones.temperatureTarget[0]);
+			LE_INFO("%s is %f, migrated to %s", CONFIG_LEGACY_TARGET_TEMPERATURE, _zones.temperatureTarget[0], GetResource(i)->configPathPtr);
+			legacyTarget = true;
+		}
+
+		if (!missing[i] && (GetResource(i)->valuePtr == &_temperatureOutside))
+		{
+			//a known outside temperature, start from the default temperature
+			for (zone = 0; zone < ZONE_MAX_COUNT; zone++)
+			{
+				_zones.temperature[zone] = DEFAULT_START_TEMP;
+			}
+		}
+	}
+
+	//the board type of the gpio helper lib is read in the same transaction
+	bool boardTypeMissing = !gpio_iot_LoadConfig(txnRef);
+
+	le_cfg_CancelTxn(txnRef);
 
-//AV System Data Variables
-#define VARIABLE_FAN_STATE      			"truck.var.fan.isOn"                //boolean : fan is on or off
-#define VARIABLE_FAN_DURATION   			"truck.var.fan.duration"            //int : how long it's been functioning (minute)
-#define VARIABLE_TEMP_CURRENT   			"truck.var.temp.current"            //float : current temperature
-#define VARIABLE_DOOR_STATE     			"truck.var.door.isOpen"             //boolean : door is opened or closed
+	if (missingCount || boardTypeMissing)
+	{
+		//missing keys in config tree, let's save their default values to config tree
+		LE_INFO("%zu settings missing in config tree, saving their default value", missingCount + boardTypeMissing);
+
+		txnRef = le_cfg_CreateWriteTxn("/");
+
+		for (i = 0; i < GetResourceCount(); i++)
+		{
+			if (missing[i])
+			{
+				WriteConfigEntry(txnRef, GetResource(i)->configPathPtr, GetResource(i)->type, GetResource(i)->valuePtr);
+			}
+		}
+
+		if (boardTypeMissing)
+		{
+			gpio_iot_SaveConfig(txnRef);
+		}
+
+		if (legacyTarget)
+		{
+			le_cfg_DeleteNode(txnRef, CONFIG_LEGACY_TARGET_TEMPERATURE);
+		}
+
+		le_cfg_CommitTxn(txnRef);
+	}
+
+	//a compartment count out of range falls back to the nearest valid one
+	_zoneCount = (_zoneCount < 1) ? 1 : ((_zoneCount > ZONE_MAX_COUNT) ? ZONE_MAX_COUNT : _zoneCount);
+}
+
+//callback to handle the data push status
+static void PushDataCallbackHandler
+(
+    le_avdata_PushStatus_t status,
+    void* contextPtr
+)
+{
+    trace_Add(TRACE_STATE_ACK, status, 0, 0);
+
+    if (LE_AVDATA_PUSH_FAILED == status)
+    {
+    	LE_WARN("Failed to Push Data... check connection !");
+
+    	//what the push carried is not known here : the whole state goes with the next state push
+    	_pendingState |= STATE_ALL;
+    }
+
+    if (session_PushCompleted((uint32_t)(uintptr_t)contextPtr, status == LE_AVDATA_PUSH_SUCCESS) && _statePushesInFlight)
+    {
+    	_statePushesInFlight--;
+    }
+}
+
+//current time, as a timeserie timestamp (UTC in milliseconds)
+static uint64_t GetUtcMilliSec()
+{
+	struct timeval 	tv;
+	gettimeofday(&tv, NULL);
+
+	return (uint64_t)(tv.tv_sec) * 1000 + (uint64_t)(tv.tv_usec) / 1000;
+}
+
+//age of a sample (seconds)
+static uint32_t GetSampleAge(const store_Sample_t* samplePtr)
+{
+	uint64_t now = GetUtcMilliSec();
+
+	return (now > samplePtr->timestamp) ? (uint32_t)((now - samplePtr->timestamp) / 1000) : 0;
+}
+
+//true if nothing has been reported for longer than the heartbeat period
+static bool IsHeartbeatDue(time_t lastReportTime)
+{
+	return (le_clk_GetRelativeTime().sec - lastReportTime) >= _reportHeartbeat;
+}
+
+//return which state variables (STATE_xxx) changed since they were last reported
+static uint32_t GetChangedState()
+{
+	uint32_t	changed = STATE_ALL & ~_reportedState;
+	int			zone;
+
+	for (zone = 0; zone < _zoneCount; zone++)
+	{
+		if (_zones.fanIsOn[zone] != _reportedZones.fanIsOn[zone])
+		{
+			changed |= STATE_FAN;
+		}
+
+		if (_zones.doorIsOpen[zone] != _reportedZones.doorIsOpen[zone])
+		{
+			changed |= STATE_DOOR;
+		}
+	}
+
+	if (_tempAlarm != _reportedTempAlarm)
+	{
+		changed |= STATE_TEMP_ALARM;
+	}
+
+	if (_fanFailure != _reportedFanFailure)
+	{
+		changed |= STATE_FAN_FAILURE;
+	}
+
+	return changed;
+}
+
+//push the selected state variables (STATE_xxx) to AV together in one record : a single transaction and a single callback
+//the fan and door states are pushed for every compartment
+//While the session is down or stalled, the state is held and pushed when the session is back
+//A state which cannot be pushed is held the same way, and retried with the next state push or when the session is back
+le_result_t PushState(uint32_t stateMask)
+{
+	int						zone;
+
+	if (!session_CanPush())
+	{
+		_pendingState |= stateMask;
+		return LE_UNAVAILABLE;
+	}
+
+	le_avdata_RecordRef_t 	recordRef = record_Acquire();
+	uint64_t				utcMilliSec = GetUtcMilliSec();
+
+	if (NULL == recordRef)
+	{
+		_pendingState |= stateMask;
+		return LE_NO_MEMORY;
+	}
+
+	for (zone = 0; zone < _zoneCount; zone++)
+	{
+		if (stateMask & STATE_FAN)
+		{
+			le_avdata_RecordBool(recordRef, _zoneResources[zone][ZONE_RES_FAN_STATE].pathPtr, _zones.fanIsOn[zone], utcMilliSec);
+		}
+
+		if (stateMask & STATE_DOOR)
+		{
+			le_avdata_RecordBool(recordRef, _zoneResources[zone][ZONE_RES_DOOR_STATE].pathPtr, _zones.doorIsOpen[zone], utcMilliSec);
+		}
+	}
+
+	if (stateMask & STATE_TEMP_ALARM)
+	{
+		le_avdata_RecordBool(recordRef, VARIABLE_TEMP_ALARM, _tempAlarm, utcMilliSec);
+	}
+
+	if (stateMask & STATE_FAN_FAILURE)
+	{
+		le_avdata_RecordBool(recordRef, VARIABLE_FAN_FAILURE, _fanFailure, utcMilliSec);
+	}
+
+	le_result_t result = le_avdata_PushRecord(recordRef, PushDataCallbackHandler, (void*)(uintptr_t)session_GetEpoch());
+
+	trace_Add(TRACE_STATE_PUSH, stateMask, result, 0);
+
+	if (LE_OK != result)
+	{
+		LE_WARN("Failed to push State");
+		_pendingState |= stateMask;
+	}
+	else
+	{
+		session_PushIssued();
+		_statePushesInFlight++;
+
+		//remember what has been reported
+		for (zone = 0; zone < _zoneCount; zone++)
+		{
+			_reportedZones.fanIsOn[zone] = (stateMask & STATE_FAN) ? _zones.fanIsOn[zone] : _reportedZones.fanIsOn[zone];
+			_reportedZones.doorIsOpen[zone] = (stateMask & STATE_DOOR) ? _zones.doorIsOpen[zone] : _reportedZones.doorIsOpen[zone];
+		}
+		_reportedTempAlarm = (stateMask & STATE_TEMP_ALARM) ? _tempAlarm : _reportedTempAlarm;
+		_reportedFanFailure = (stateMask & STATE_FAN_FAILURE) ? _fanFailure : _reportedFanFailure;
+		_reportedState |= stateMask;
+		_pendingState &= ~stateMask;
+
+		if ((stateMask & STATE_ALL) == STATE_ALL)
+		{
+			_stateReportTime = le_clk_GetRelativeTime().sec;
+		}
+	}
+
+	record_Release(recordRef, false);
+
+	return result;
+}
+
+//set the value of the selected state variables (STATE_xxx)
+static void SetStateVariables(uint32_t stateMask)
+{
+	int zone;
+
+	for (zone = 0; zone < _zoneCount; zone++)
+	{
+		if (stateMask & STATE_FAN)
+		{
+			le_avdata_SetBool(_zoneResources[zone][ZONE_RES_FAN_STATE].pathPtr, _zones.fanIsOn[zone]);
+		}
+
+		if (stateMask & STATE_DOOR)
+		{
+			le_avdata_SetBool(_zoneResources[zone][ZONE_RES_DOOR_STATE].pathPtr, _zones.doorIsOpen[zone]);
+		}
+	}
+
+	if (stateMask & STATE_TEMP_ALARM)
+	{
+		le_avdata_SetBool(VARIABLE_TEMP_ALARM, _tempAlarm);
+	}
+
+	if (stateMask & STATE_FAN_FAILURE)
+	{
+		le_avdata_SetBool(VARIABLE_FAN_FAILURE, _fanFailure);
+	}
+}
+
+//push the Fan status, Door status and alarms, trigger by the dataPush timer
+//In report-by-exception mode, only the changed status are pushed, everything is pushed once per heartbeat
+void pushData(void* contextPtr)
+{
+	uint32_t stateMask = STATE_ALL;
+
+	if (_reportByException && !IsHeartbeatDue(_stateReportTime))
+	{
+		stateMask = GetChangedState();
+
+		if (0 == stateMask)
+		{
+			return;
+		}
+	}
+
+	SetStateVariables(STATE_ALL);
+
+	PushState(stateMask);
+}
+
+//push the queued state changes, with the value of the state variables
+static void OnStatePushTimer(le_timer_Ref_t timerRef)
+{
+	uint32_t stateMask = _pendingState;
+
+	if (stateMask)
+	{
+		SetStateVariables(stateMask);
+		PushState(stateMask);
+	}
+}
+
+//queue the push of state changes (STATE_xxx) : the caller does not wait for AV, changes close together go in one push
+static void QueueStatePush(uint32_t stateMask)
+{
+	_pendingState |= stateMask;
+
+	if (NULL == _statePushTimerRef)
+	{
+		_statePushTimerRef = le_timer_Create("statePushTimer");
+		le_timer_SetMsInterval(_statePushTimerRef, STATE_PUSH_DELAY_MS);
+		le_timer_SetHandler(_statePushTimerRef, OnStatePushTimer);
+	}
+
+	if (!le_timer_IsRunning(_statePushTimerRef))
+	{
+		le_timer_Start(_statePushTimerRef);
+	}
+}
+
+//push the raised alarms, from the event loop : the queued state changes and the current timeserie go along
+static void OnAlarmPush(void* param1Ptr, void* param2Ptr)
+{
+	_alarmPushQueued = false;
+
+	if (_statePushTimerRef)
+	{
+		le_timer_Stop(_statePushTimerRef);
+	}
+	OnStatePushTimer(NULL);
+
+	//the current window is summarized early, to go along
+	if (!_aggregateRaw)
+	{
+		SummarizeWindow(NULL);
+	}
+
+	if (_recordRef && session_CanPush())
+	{
+		PushTimeserie();
+	}
+}
+
+//high priority lane : push the alarm (STATE_xxx) as soon as the caller returns to the event loop, without the state push delay
+//routine data keeps on batching, an alarm does not wait for it ; a command is replied before the alarm is pushed
+static void PushAlarm(uint32_t stateMask)
+{
+	_pendingState |= stateMask;
+
+	if (!_alarmPushQueued)
+	{
+		_alarmPushQueued = true;
+		le_event_QueueFunction(OnAlarmPush, NULL, NULL);
+	}
+}
+
+//raise or clear the temperature alarm from the warmest compartment
+static void CheckTemperatureAlarm()
+{
+	double	temperature = _zones.temperature[0];
+	int		zone;
+
+	for (zone = 1; zone < _zoneCount; zone++)
+	{
+		temperature = fmax(temperature, _zones.temperature[zone]);
+	}
+
+	if (!_tempAlarm && (temperature > _temperatureAlarm))
+	{
+		trace_Add(TRACE_TEMP_ALARM, TRACE_MILLI(temperature), TRACE_MILLI(_temperatureAlarm), 0);
+		_tempAlarm = true;
+		PushAlarm(STATE_TEMP_ALARM);
+	}
+	else if (_tempAlarm && (temperature < _temperatureAlarm - TEMP_ALARM_HYSTERESIS))
+	{
+		_tempAlarm = false;
+		QueueStatePush(STATE_TEMP_ALARM);
+	}
+}
+
+//drive the fan motor and the door LED of compartment 0 together from its current state, outputs already at the right level are skipped
+//the fan failure alarm is raised when the fan is on but its motor cannot be driven
+void ApplyActuators()
+{
+	bool		fanIsOn = _zones.fanIsOn[0];
+	uint32_t	values = (fanIsOn ? GPIO_IOT_MASK(GPIO_PIN_FAN_MOTOR) : 0) | (_zones.doorIsOpen[0] ? GPIO_IOT_MASK(GPIO_PIN_DOOR_LED) : 0);
+	bool		failed = (LE_OK != gpio_iot_SetOutputs(GPIO_ACTUATORS_MASK, values));
+
+	if (failed)
+	{
+		LE_WARN("Failed to drive actuators");
+	}
+
+	if ((failed && fanIsOn) != _fanFailure)
+	{
+		_fanFailure = failed && fanIsOn;
+
+		if (_fanFailure)
+		{
+			PushAlarm(STATE_FAN_FAILURE);
+		}
+		else
+		{
+			QueueStatePush(STATE_FAN_FAILURE);
+		}
+	}
+}
+
+//function to switch the fan of a compartment on/off, and turning the fan motor on/off. Can also queue the push of the new fan status to AV
+void SwitchFan(int zone, bool bturnOn, bool pushData)
+{
+	_zones.fanIsOn[zone] = bturnOn;
+
+	if (0 == zone)
+	{
+		ApplyActuators();
+	}
+
+	if (pushData)
+	{
+		QueueStatePush(STATE_FAN);
+	}
+
+	if (!bturnOn)
+	{
+		thermal_ResetFanDuration(&_thermalZones, zone);
+	}
+}
+
+//function to open/close the door of a compartment, and turning the door led on/off. Can also queue the push of the new door status to AV
+void SwitchDoor(int zone, bool bOpen, bool pushData)
+{
+	_zones.doorIsOpen[zone] = bOpen;
+
+	if (0 == zone)
+	{
+		ApplyActuators();
+	}
+
+	if (pushData && bOpen)
+	{
+		//an opened door is an alarm, the cold chain is broken
+		PushAlarm(STATE_DOOR);
+	}
+	else if (pushData)
+	{
+		QueueStatePush(STATE_DOOR);
+	}
+}
+
+//seconds of the boot clock : monotonic whatever NTP or the network does to the wall clock, the time suspended counts
+static double GetBootSec()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_BOOTTIME, &now);
+
+	return (double)now.tv_sec + (double)now.tv_nsec / 1000000000.0;
+}
+
+//advance the thermal model of every compartment up to now, the fans which reached their target temp meanwhile are turned off
+//the temp each compartment converged to is returned in convergedToPtr (ZONE_MAX_COUNT doubles)
+static void AdvanceZones(double* convergedToPtr)
+{
+	double			now = GetBootSec();
+	double			elapsedSec = now - _thermalTime;
+	bool			stopped[ZONE_MAX_COUNT];
+	int				zone;
+
+	_thermalTime = now;
+
+	//every compartment has converged long before, a longer gap only grows the duration of a fan running door open
+	if (elapsedSec > THERMAL_MAX_ELAPSED_SEC)
+	{
+		elapsedSec = THERMAL_MAX_ELAPSED_SEC;
+	}
+
+	thermal_Advance(&_thermalZones, _zoneCount, (double)_temperatureOutside, elapsedSec, convergedToPtr, stopped);
+
+	for (zone = 0; zone < _zoneCount; zone++)
+	{
+		if (stopped[zone])
+		{
+			trace_Add(TRACE_FAN_STOPPED, zone, TRACE_MILLI(_zones.temperature[zone]), 0);
+			SwitchFan(zone, false, true);   //reach target temp, turn off Fan
+		}
+	}
+}
+
+//enter or leave the sleep of the low-power mode
+static void SetSleeping(bool bSleeping)
+{
+	if (bSleeping != _sleeping)
+	{
+		_sleeping = bSleeping;
+		LE_INFO("Low-power mode : %s", _sleeping ? "sleeping" : "awake");
+		ApplyJobPeriods(0);
+	}
+}
+
+//an event is about to change the state of a compartment : the compartments are brought up to date first, and the truck wakes up
+static void WakeUp()
+{
+	double convergedTo[ZONE_MAX_COUNT];
+
+	AdvanceZones(convergedTo);
+	SetSleeping(false);
+}
+
+//Setting handlers, called once the new value is stored
+//periods of the periodic jobs : while asleep, the data generation is stretched and runs alone, it pushes everything once per wake cycle
+static void ApplyJobPeriods(int zone)
+{
+	scheduler_SetJobPeriod(_dataGenJobRef, (_sleeping && (_sleepInterval > 0)) ? _sleepInterval : _dataGenInterval);
+	scheduler_SetJobPeriod(_dataPushJobRef, _sleeping ? 0 : _dataPushInterval);
+	scheduler_SetJobPeriod(_aggregateJobRef, (_sleeping || _aggregateRaw) ? 0 : _aggregateWindow);
+	scheduler_SetJobPeriod(_flushJobRef, _sleeping ? 0 : _batchLatency);
+	scheduler_SetJobPeriod(_diagJobRef, (_sleeping || (_diagInterval <= 0)) ? 0 : _diagInterval);
+}
+
+static void ApplyLowPower(int zone)
+{
+	position_SetFixInterval(_lowPower ? _fixInterval : 0);
+
+	//out of low-power mode, the truck is awake
+	_sleeping = _sleeping && _lowPower;
+	ApplyJobPeriods(zone);
+}
+
+static void ApplyUplink(int zone)
+{
+	uplink_SetMinQuality((_uplinkMinQuality > 0) ? _uplinkMinQuality : 0);
+	uplink_SetMaxDelay((_uplinkMaxDelay > 0) ? _uplinkMaxDelay : 0);
+}
+
+static void ApplyMangohType(int zone)
+{
+	gpio_iot_SetMangohType(_mangohBoardType);
+
+	//AirVantage reads back the board type in use
+	_mangohBoardType = gpio_iot_GetMangohType();
+}
+
+static void ApplyGnssThresholds(int zone)
+{
+	position_SetMovementThresholds(_gnssHDistance, _gnssVDistance);
+}
+
+static void ApplyMaxInFlight(int zone)
+{
+	session_SetMaxInFlight(_maxInFlight);
+}
+
+static void ApplyAggregation(int zone)
+{
+	//the samples of the current window are not lost when switching to raw samples
+	SummarizeWindow(NULL);
+
+	ApplyJobPeriods(zone);
+}
+
+static void CreateZoneResources();
+
+static void ApplyZoneCount(int zone)
+{
+	int requestedCount = _zoneCount;
+
+	_zoneCount = (_zoneCount < 1) ? 1 : ((_zoneCount > ZONE_MAX_COUNT) ? ZONE_MAX_COUNT : _zoneCount);
+
+	if (_zoneCount != requestedCount)
+	{
+		le_avdata_SetInt(SETTING_ZONE_COUNT, _zoneCount);
+	}
+
+	//the samples of the current window are summarized with the previous compartments
+	SummarizeWindow(NULL);
+
+	CreateZoneResources();
+
+	//the compartments added are reported with the next push
+	QueueStatePush(STATE_FAN | STATE_DOOR);
+}
+
+//Command handlers : the compartments are brought up to date before their state changes, the truck wakes up
+static void StartFan(int zone)
+{
+	WakeUp();
+	SwitchFan(zone, true, true);
+}
+
+static void StopFan(int zone)
+{
+	WakeUp();
+	SwitchFan(zone, false, true);
+}
+
+static void OpenDoor(int zone)
+{
+	WakeUp();
+	SwitchDoor(zone, true, true);
+}
+
+static void CloseDoor(int zone)
+{
+	WakeUp();
+	SwitchDoor(zone, false, true);
+}
+
+//Command handler of the truck : format the trace of the hot path events to the log, the truck is not woken up
+static void DumpTrace(int zone)
+{
+	trace_Dump();
+}
+
+//Set the AirVantage value of a resource from its storage
+static void SetResourceValue(const Resource_t* resPtr)
+{
+	switch (resPtr->type)
+	{
+		case RESOURCE_TYPE_INT:
+			le_avdata_SetInt(resPtr->pathPtr, *(int*)resPtr->valuePtr);
+			break;
+
+		case RESOURCE_TYPE_FLOAT:
+			le_avdata_SetFloat(resPtr->pathPtr, *(double*)resPtr->valuePtr);
+			break;
+
+		case RESOURCE_TYPE_BOOL:
+			le_avdata_SetBool(resPtr->pathPtr, *(bool*)resPtr->valuePtr);
+			break;
+
+		default:
+			break;
+	}
+}
+
+//Get the new value of a setting from AirVantage into its storage, false if it is unchanged
+static bool GetResourceValue(const Resource_t* resPtr)
+{
+	bool changed = false;
+
+	switch (resPtr->type)
+	{
+		case RESOURCE_TYPE_INT:
+		{
+			int32_t value = *(int*)resPtr->valuePtr;
+			le_avdata_GetInt(resPtr->pathPtr, &value);
+
+			//an out of range value is rejected, AirVantage reads the previous one back
+			if (!IsInRange(resPtr, value))
+			{
+				LE_WARN("%s : %" PRId32 " is out of %d..%d, %d kept", resPtr->pathPtr, value,
+						resPtr->minValue, resPtr->maxValue, *(int*)resPtr->valuePtr);
+				value = *(int*)resPtr->valuePtr;
+				le_avdata_SetInt(resPtr->pathPtr, value);
+			}
+
+			changed = (value != *(int*)resPtr->valuePtr);
+			*(int*)resPtr->valuePtr = value;
+			trace_AddText(TRACE_SETTING, resPtr->pathPtr, value, changed, 0);
+			break;
+		}
+
+		case RESOURCE_TYPE_FLOAT:
+		{
+			double value = *(double*)resPtr->valuePtr;
+			le_avdata_GetFloat(resPtr->pathPtr, &value);
+			changed = (value != *(double*)resPtr->valuePtr);
+			*(double*)resPtr->valuePtr = value;
+			trace_AddText(TRACE_SETTING, resPtr->pathPtr, TRACE_MILLI(value), changed, 0);
+			break;
+		}
+
+		case RESOURCE_TYPE_BOOL:
+		{
+			bool value = *(bool*)resPtr->valuePtr;
+			le_avdata_GetBool(resPtr->pathPtr, &value);
+			changed = (value != *(bool*)resPtr->valuePtr);
+			*(bool*)resPtr->valuePtr = value;
+			trace_AddText(TRACE_SETTING, resPtr->pathPtr, value, changed, 0);
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	return changed;
+}
+
+// Callback function to handle Write Request from AV, the setting is given by the contextPtr
+static void OnWriteSetting
+(
+	const char* path,
+    le_avdata_AccessType_t accessType,
+    le_avdata_ArgumentListRef_t argumentList,
+    void* contextPtr
+)
+{
+	const Resource_t* resPtr = contextPtr;
+
+	if (!GetResourceValue(resPtr))
+	{
+		return;
+	}
+
+	if (resPtr->handlerPtr)
+	{
+		resPtr->handlerPtr(resPtr->zone);
+	}
+
+	SaveConfig();
+}
+
+//Callback function to handle Command Execution Request from AV, the command is given by the contextPtr
+static void OnCommand
+(
+	const char* path,
+    le_avdata_AccessType_t accessType,
+    le_avdata_ArgumentListRef_t argumentList,
+    void* contextPtr
+)
+{
+	const Resource_t*	resPtr = contextPtr;
+	le_clk_Time_t		startTime = le_clk_GetRelativeTime();
+
+	resPtr->handlerPtr(resPtr->zone);
+
+	//the actuator is driven, reply right away : the state push or the alarm push is queued, not waited for
+	le_clk_Time_t latency = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+	le_avdata_ReplyExecResult(argumentList, LE_OK);
+
+	_commandLatency = latency.sec * 1000000 + latency.usec;
+	le_avdata_SetInt(VARIABLE_CMD_LATENCY, _commandLatency);
+	trace_AddText(TRACE_COMMAND, resPtr->pathPtr, _commandLatency, 0, 0);
+}
+
+//Create a resource, a setting or a command gets its handler bound through the contextPtr
+static void CreateResource(const Resource_t* resPtr)
+{
+	le_avdata_CreateResource(resPtr->pathPtr, resPtr->accessMode);
+	SetResourceValue(resPtr);
+
+	if (LE_AVDATA_ACCESS_SETTING == resPtr->accessMode)
+	{
+		le_avdata_AddResourceEventHandler(resPtr->pathPtr, OnWriteSetting, (void*)resPtr);
+	}
+	else if (LE_AVDATA_ACCESS_COMMAND == resPtr->accessMode)
+	{
+		le_avdata_AddResourceEventHandler(resPtr->pathPtr, OnCommand, (void*)resPtr);
+	}
+}
+
+//Create the resources of the compartments in use which are not created yet
+static void CreateZoneResources()
+{
+	size_t i;
+
+	for ( ; _zoneCreatedCount < _zoneCount; _zoneCreatedCount++)
+	{
+		for (i = 0; i < ZONE_RESOURCE_COUNT; i++)
+		{
+			CreateResource(&_zoneResources[_zoneCreatedCount][i]);
+		}
+	}
+}
+
+//Create every resource of the truck, then the resources of the compartments in use
+static void CreateResources()
+{
+	size_t i;
+
+	for (i = 0; i < NUM_ARRAY_MEMBERS(_resources); i++)
+	{
+		CreateResource(&_resources[i]);
+	}
 
-static bool 	                 			_fanIsOn = true;
-static int 	                    			_fanDuration = 0;
-static double                   			_temperature = 4.2;                 //current temp
-static bool 	                 			_doorIsOpen = false;
+	CreateZoneResources();
+}
 
+//true if the kind of sample is an int
+static bool IsIntSample(uint32_t kind)
+{
+	return (SAMPLE_FAN_DURATION == kind) || (SAMPLE_TEMP_COUNT == kind);
+}
 
-//AV System Data Settings
-#define SETTING_TEMP_TARGET     			"truck.set.temp.target"             //float : target regulated temperature
-#define SETTING_TEMP_AIR        			"truck.set.temp.outside"            //int : outside air temperature
-#define SETTING_DATAGEN_INTERVAL 			"truck.set.interval.datagen"
-#define SETTING_DATAPUSH_INTERVAL			"truck.set.interval.datapush"
-#define SETTING_MANGOH_TYPE					"truck.set.mangohType"
+//Record a stored sample in a timeserie, under the path of its compartment
+static le_result_t RecordSample(le_avdata_RecordRef_t recordRef, const store_Sample_t* samplePtr)
+{
+	uint32_t	zone = samplePtr->resourceId / SAMPLE_KIND_COUNT;
+	uint32_t	kind = samplePtr->resourceId % SAMPLE_KIND_COUNT;
 
-#define FIELDNAME_DATAGEN					"datagen"
-#define FIELDNAME_DATAPUSH					"datapush"
-#define FIELDNAME_AIR_TEMP					"outside"
-#define FIELDNAME_AC_TARGET_TEMP			"target"
-#define FIELDNAME_MANGOH_TYPE				"mangohType"
+	if (zone >= ZONE_MAX_COUNT)
+	{
+		LE_WARN("Unknown stored sample %u, skipped", samplePtr->resourceId);
+		return LE_OK;
+	}
 
-static double                   			_temperatureTarget = 2.2;
-static int                      			_temperatureOutside = 27;
-static int									_dataGenInterval = 5;				//5 seconds
-static int									_dataPushInterval = 20;				//30 seconds
-static gpio_iot_mangohType_t                _mangohBoardType;                   //type of mangOH board (Red, Green)
-
-//AV Commands
-#define COMMAND_FAN_START       			"truck.cmd.startFan"                //Start fan
-#define COMMAND_FAN_STOP        			"truck.cmd.stopFan"                 //Stop fan
-#define FIELDNAME_START_FAN					"startFan"
-#define FIELDNAME_STOP_FAN					"stopFan"
-#define COMMAND_OPEN_DOOR       			"truck.cmd.openDoor"                //Open door
-#define COMMAND_CLOSE_DOOR        			"truck.cmd.closeDoor"                 //Close door
-#define FIELDNAME_OPEN_DOOR					"openDoor"
-#define FIELDNAME_CLOSE_DOOR				"closeDoor"
+	if (IsIntSample(kind))
+	{
+		return le_avdata_RecordInt(recordRef, _samplePaths[zone][kind], (int32_t)samplePtr->value, samplePtr->timestamp);
+	}
 
-//Default behavior
-#define DEFAULT_START_TEMP 					5.2         //default starting point of the current temperature
-#define TIMESERIE_MAX_RECORD				6           //number of record to accumulated before pushing to AV as timeserie
-#define TEMPERATURE_INC_STEP				0.4         //temperature increment step for simulation
-#define FAN_DURATION_INC_STEP   			5           //Fan duration increment step for the simulation
+	return le_avdata_RecordFloat(recordRef, _samplePaths[zone][kind], samplePtr->value, samplePtr->timestamp);
+}
 
+//Keep a sample aside in the current batch
+static void BatchSample(const store_Sample_t* samplePtr)
+{
+	_batchPtr->samples[_batchPtr->count++] = *samplePtr;
+}
 
-//Other
-static le_timer_Ref_t						_dataGenTimerRef = NULL;              //reference to data generation/simulation timer
-static le_timer_Ref_t						_dataPushTimerRef = NULL;             //reference to push data timer
-static le_avdata_RecordRef_t 				_recordRef = NULL;                    //reference to the timeserie data
-static int 									_recordCount = 0;                     //timeserie record counter
+//Estimated encoded size of a sample value
+static size_t GetSampleBytes(const store_Sample_t* samplePtr)
+{
+	return IsIntSample(samplePtr->resourceId % SAMPLE_KIND_COUNT) ? TIMESERIE_INT_BYTES : TIMESERIE_FLOAT_BYTES;
+}
 
-static le_avdata_RequestSessionObjRef_t		_truck_requestSessionRef = NULL;      //reference to AV session request
+//A timeserie push is over : samples which did not make it are kept on flash, to be replayed later
+static void CompleteBatch(TimeserieBatch_t* batchPtr, bool delivered)
+{
+	if (!delivered && batchPtr->count)
+	{
+		if (LE_OK == store_Append(batchPtr->samples, batchPtr->count))
+		{
+			trace_Add(TRACE_TIMESERIE_STORED, batchPtr->count, store_GetCount(), 0);
+		}
+	}
 
+	le_mem_Release(batchPtr);
+}
 
-// Save current settings to config tree
-void SaveConfig()
+//Callback function to handle the replay push status
+static void ReplayCallbackHandler
+(
+    le_avdata_PushStatus_t status,
+    void* contextPtr
+)
 {
-	le_cfg_QuickSetInt(CONFIG_DATAGEN_INTERVAL, _dataGenInterval);
+	//a replay of a stopped session is replayed again, its samples are still stored
+	if (!session_PushCompleted((uint32_t)(uintptr_t)contextPtr, status == LE_AVDATA_PUSH_SUCCESS))
+	{
+		return;
+	}
 
-	le_cfg_QuickSetInt(CONFIG_DATAPUSH_INTERVAL, _dataPushInterval);
+	_replayInFlight = false;
 
-	le_cfg_QuickSetInt(CONFIG_AIR_TEMPERATURE, _temperatureOutside);
+    if (status == LE_AVDATA_PUSH_SUCCESS)
+ 	{
+ 		store_Ack(_replayNextSeq);
+ 	}
+ 	else
+ 	{
+ 		//wait for the next session to retry
+ 		LE_WARN("Failed to replay stored samples");
+ 	}
 
-	le_cfg_QuickSetFloat(CONFIG_TARGET_TEMPERATURE, _temperatureTarget);
-}
+ 	trace_Add(TRACE_REPLAY_ACK, status, store_GetCount(), 0);
 
+ 	//keep on replaying at the replay pace, until the store is empty
+ 	if ((status != LE_AVDATA_PUSH_SUCCESS) || (0 == store_GetCount()))
+ 	{
+ 		scheduler_SetJobPeriod(_replayJobRef, 0);
+ 		_replayActive = false;
+ 	}
+}
 
-// Load parameters from config tree
-void LoadConfig()
+//Push the oldest stored samples in one timeserie
+static void ReplayStoredSamples(void* contextPtr)
 {
-	int 	cfgValue;
-	bool	save = false;
+	uint32_t	nextSeq;
+	size_t		count;
+	size_t		i;
 
-	cfgValue = le_cfg_QuickGetInt(CONFIG_DATAGEN_INTERVAL, -1);
-	if (cfgValue < 0)
+	if (_replayInFlight)
 	{
-		save = true;
+		return;
 	}
-	else
+
+	if ((0 == store_GetCount()) || !session_IsConnected())
 	{
-		_dataGenInterval = cfgValue;
+		//nothing to replay, or wait for the next session
+		scheduler_SetJobPeriod(_replayJobRef, 0);
+		_replayActive = false;
+		return;
 	}
-	LE_INFO("Data Gen Interval is %d seconds...", _dataGenInterval);
 
-	cfgValue = le_cfg_QuickGetInt(CONFIG_DATAPUSH_INTERVAL, -1);
-	if (cfgValue < 0)
+	if (!session_CanPush())
 	{
-		save = true;
+		//stalled, retry at the next replay tick
+		return;
 	}
-	else
+
+	//the samples are read from flash only once the replay can go
+	count = store_Peek(_replaySamples, REPLAY_MAX_SAMPLES, &nextSeq);
+
+	if (0 == count)
+	{
+		scheduler_SetJobPeriod(_replayJobRef, 0);
+		_replayActive = false;
+		return;
+	}
+
+	if (!uplink_CanUpload(GetSampleAge(&_replaySamples[0])))
 	{
-		_dataPushInterval = cfgValue;
-	}	
-	LE_INFO("Data Pushing Interval is %d seconds...", _dataPushInterval);
+		//poor radio, the replay goes on with the next timeserie acknowledged
+		scheduler_SetJobPeriod(_replayJobRef, 0);
+		_replayActive = false;
+		return;
+	}
+
+	le_avdata_RecordRef_t recordRef = record_Acquire();
 
-	
-	cfgValue = le_cfg_QuickGetInt(CONFIG_AIR_TEMPERATURE, -1);
-	if (cfgValue < 0)
+	if (NULL == recordRef)
 	{
-		save = true;
+		return;
 	}
-	else
+
+	for (i = 0; i < count; i++)
+	{
+		if (LE_OK != RecordSample(recordRef, &_replaySamples[i]))
+		{
+			//record is full, the remaining samples go with the next replay
+			store_Peek(_replaySamples, i, &nextSeq);
+			break;
+		}
+	}
+
+	if (0 == i)
+	{
+		//nothing recorded, the record can be reused
+		record_Release(recordRef, true);
+		return;
+	}
+
+	if (LE_OK == le_avdata_PushRecord(recordRef, ReplayCallbackHandler, (void*)(uintptr_t)session_GetEpoch()))
 	{
-		_temperatureOutside = cfgValue;
-		_temperature = DEFAULT_START_TEMP;
-	}	
-	LE_INFO("Air Temperature is %d degrees...", _temperatureOutside);
+		trace_Add(TRACE_REPLAY_PUSH, i, 0, 0);
+		_replayNextSeq = nextSeq;
+		_replayInFlight = true;
+		session_PushIssued();
+	}
 
+	record_Release(recordRef, false);
+}
 
-	float fValue = le_cfg_QuickGetFloat(CONFIG_TARGET_TEMPERATURE, 0.05);
-	if (fValue == 0.05)
+//Start replaying the stored samples, if any
+static void StartReplay()
+{
+	if (store_GetCount() && !_replayInFlight && !_replayActive)
 	{
-		save = true;
+		_replayActive = true;
+		scheduler_SetJobPeriod(_replayJobRef, REPLAY_INTERVAL);
+
+		ReplayStoredSamples(NULL);
 	}
-	else
+}
+
+//Take a pushed batch back from the ones in flight by its id, NULL if it is no longer in flight (stored when the session stopped)
+static TimeserieBatch_t* TakeBatchInFlight(uint32_t id)
+{
+	TimeserieBatch_t** batchPtrPtr = &_batchesInFlight;
+
+	while (*batchPtrPtr && ((*batchPtrPtr)->id != id))
 	{
-		_temperatureTarget = fValue;
+		batchPtrPtr = &(*batchPtrPtr)->nextPtr;
 	}
-	LE_INFO("Target Temperature is %f degrees...", _temperatureTarget);
 
-	if (save)
+	TimeserieBatch_t* batchPtr = *batchPtrPtr;
+
+	if (batchPtr)
 	{
-		//missing keys in config tree, let's save default values to config tree
-		SaveConfig();
+		*batchPtrPtr = batchPtr->nextPtr;
 	}
+
+	return batchPtr;
 }
 
-//callback to handle the data push status
-static void PushDataCallbackHandler
+//Callback function to handle the timeserie push status
+void PushRecordCallbackHandler
 (
     le_avdata_PushStatus_t status,
     void* contextPtr
 )
 {
-    LE_INFO("PushDataCallbackHandler : %d", status);
+    trace_Add(TRACE_TIMESERIE_ACK, status, 0, 0);
 
-    if (LE_AVDATA_PUSH_FAILED == status)
-    {
-    	LE_INFO("Failed to Push Data... check connection !");
-    }
-    else
+    TimeserieBatch_t* batchPtr = TakeBatchInFlight((uint32_t)(uintptr_t)contextPtr);
+
+    if (NULL == batchPtr)
     {
-    	LE_INFO("Push Data OK & ACKed");
+    	//pushed in a stopped session, its samples are already stored
+    	return;
     }
 
+    if (status != LE_AVDATA_PUSH_SUCCESS)
+ 	{
+ 		LE_WARN("Failed to push Timeserie");
+ 	}
+
+ 	uint32_t epoch = batchPtr->epoch;
+
+ 	CompleteBatch(batchPtr, status == LE_AVDATA_PUSH_SUCCESS);
+ 	session_PushCompleted(epoch, status == LE_AVDATA_PUSH_SUCCESS);
+
+ 	//the link is fine, good time to catch up
+ 	if (status == LE_AVDATA_PUSH_SUCCESS)
+ 	{
+ 		StartReplay();
+ 	}
 }
 
-//push the Fan status and Door status, trigger by the dataPush timer
-void pushData(le_timer_Ref_t  timerRef)
+
+//Push the current timeserie, its samples are kept in the batch until the push is acknowledged
+static void PushTimeserie()
 {
-	LE_INFO("--- Pushing data to AV...");
+	_batchPtr->id = ++_batchId;
+	_batchPtr->epoch = session_GetEpoch();
+
+	le_result_t result = le_avdata_PushRecord(_recordRef, PushRecordCallbackHandler, (void*)(uintptr_t)_batchPtr->id);
 
-	le_avdata_SetBool(VARIABLE_FAN_STATE, _fanIsOn);
-	if (LE_FAULT == le_avdata_Push(VARIABLE_FAN_STATE, PushDataCallbackHandler, NULL))
+	trace_Add(TRACE_TIMESERIE_PUSH, _recordCount, _recordBytes, result);
+
+	if (LE_OK != result)
 	{
-		LE_INFO("Failed to push Fan State");
+		LE_WARN("Failed pushing timeseries");
+		CompleteBatch(_batchPtr, false);
 	}
-
-	le_avdata_SetBool(VARIABLE_DOOR_STATE, _doorIsOpen);
-	if (LE_FAULT == le_avdata_Push(VARIABLE_DOOR_STATE, PushDataCallbackHandler, NULL))
+	else
 	{
-		LE_INFO("Failed to push Door State");
+		_batchPtr->nextPtr = _batchesInFlight;
+		_batchesInFlight = _batchPtr;
+		session_PushIssued();
 	}
+
+	record_Release(_recordRef, false);
+	_recordRef = NULL;
+	_batchPtr = NULL;
 }
 
-//function to switch the fan on/off, and turning the fan motor on/off. Can also push the new fan status to AV
-void SwitchFan(bool bturnOn, bool pushData)
+//true if the current timeserie can be pushed : the uplink is up, and the radio is good or its oldest sample waited long enough
+//without the store, a timeserie held for the radio would be lost : it is pushed whatever the radio
+static bool CanPushTimeserie()
 {
-	_fanIsOn = bturnOn;
+	return session_CanPush() && (!_storeOpened || uplink_CanUpload(_batchPtr->count ? GetSampleAge(&_batchPtr->samples[0]) : 0));
+}
 
-	if (pushData)
+//Keep the samples of the current timeserie on flash instead of pushing it, they are replayed when the session or the radio is back
+static void StoreTimeserie()
+{
+	CompleteBatch(_batchPtr, false);
+
+	record_Release(_recordRef, false);
+	_recordRef = NULL;
+	_batchPtr = NULL;
+}
+
+//Start a new timeserie record if there is none, false if no record is available
+static bool OpenTimeserie(uint64_t timestamp)
+{
+	if (_recordRef)
 	{
-		le_avdata_SetBool(VARIABLE_FAN_STATE, _fanIsOn);
-		if (LE_FAULT == le_avdata_Push(VARIABLE_FAN_STATE, PushDataCallbackHandler, NULL))
-		{
-			LE_INFO("Failed to push Fan State");
-		}
+		return true;
 	}
 
-	gpio_iot_SetOutput(GPIO_PIN_FAN_MOTOR, _fanIsOn);
+	_recordRef = record_Acquire();
 
-	if (!_fanIsOn)
+	if (NULL == _recordRef)
 	{
-		_fanDuration = 0;
+		return false;
 	}
-}
 
-//function to open/close the door, and turning the door led on/off. Can also push the new door status to AV
-void SwitchDoor(bool bOpen, bool pushData)
-{
-	_doorIsOpen = bOpen;
+	_batchPtr = le_mem_ForceAlloc(_batchPool);
+	_batchPtr->count = 0;
+	_recordCount = 0;
+	_recordBytes = TIMESERIE_HEADER_BYTES + _zoneCount * TIMESERIE_ZONE_HEADER_BYTES;
 
-	if (pushData)
+	//the location rides along with the samples of the timeserie
+	if (LE_OK == position_AppendToRecord(_recordRef, timestamp))
 	{
-		le_avdata_SetBool(VARIABLE_DOOR_STATE, _doorIsOpen);
-		if (LE_FAULT == le_avdata_Push(VARIABLE_DOOR_STATE, PushDataCallbackHandler, NULL))
-		{
-			LE_INFO("Failed to push Door State");
-		}
+		_recordBytes += TIMESERIE_LOCATION_BYTES;
 	}
 
-	gpio_iot_SetOutput(GPIO_PIN_DOOR_LED, _doorIsOpen);	
+	return true;
 }
 
-// Callback function to handle Write Request from AV
-void OnWriteSetting
-(
-	const char* path,
-    le_avdata_AccessType_t accessType,
-    le_avdata_ArgumentListRef_t argumentList,
-    void* contextPtr
-)
+//The current timeserie is full : push it, or keep its samples on flash while the uplink is stalled or the radio poor
+static void CloseTimeserie()
 {
-	LE_INFO("*** OnWriteSetting *** : %s", path);
-
-	if (strstr(path, FIELDNAME_DATAGEN) != NULL)
+	if (CanPushTimeserie())
+	{
+		PushTimeserie();
+	}
+	else
 	{
-		int  newSetting = 0;
+		StoreTimeserie();
+	}
+}
 
-		LE_INFO("Setting Change: DataGenInterval was %d seconds", _dataGenInterval);
-		le_avdata_GetInt(SETTING_DATAGEN_INTERVAL, &newSetting);               //Get the new setting from AirVantage
+//Function to record samples taken at the same time in a timeserie record
+//create a new record if doesn't exist, push the serie to AV when the next samples would not fit in the batch budget
+//the flush job pushes it every batch.latency seconds otherwise
+//While the session is down, the timeserie is held until it is full, then its samples are stored for replay
+//A record filling up within the tick is closed, the remaining samples go in a new one : none is lost
+static void AccumulateSamples(const store_Sample_t* samplesPtr, size_t count)
+{
+	size_t		tickBytes = TIMESERIE_TIMESTAMP_BYTES;
+	size_t		i = 0;
 
-		if (newSetting != _dataGenInterval)
-		{
-			_dataGenInterval = newSetting;
-			LE_INFO("Setting Change: DataGenInterval is now %d seconds", _dataGenInterval);
-			SaveConfig();
-		
-			le_clk_Time_t      interval = { _dataGenInterval, 0 };                      //update temperature every 5 seconds
-			le_timer_Stop(_dataGenTimerRef);
-			le_timer_SetInterval(_dataGenTimerRef, interval);
-			le_timer_Start(_dataGenTimerRef);
-		}
-		else
+	while (i < count)
+	{
+		if (!OpenTimeserie(samplesPtr[i].timestamp))
 		{
-			LE_INFO("Setting Change: DataGenInterval is unchanged: %d seconds", _dataGenInterval);
+			//no record available, the remaining samples go straight to the store to be replayed
+			store_Append(&samplesPtr[i], count - i);
+			return;
 		}
-	}
-	else if (strstr(path, FIELDNAME_DATAPUSH) != NULL)
-	{
-		int  newSetting = 0;
 
-		LE_INFO("Setting Change: DataPushInterval was %d seconds", _dataPushInterval);
-		le_avdata_GetInt(SETTING_DATAPUSH_INTERVAL, &newSetting);               //Get the new setting from AirVantage
+		le_result_t result = RecordSample(_recordRef, &samplesPtr[i]);
 
-		if (newSetting != _dataPushInterval)
+		if (LE_OK == result)
 		{
-			_dataPushInterval = newSetting;
-			LE_INFO("Setting Change: DataPushInterval is now %d seconds", _dataPushInterval);
-			SaveConfig();
-
-			le_clk_Time_t      interval = { _dataPushInterval, 0 };                      //update temperature every 5 seconds
-			le_timer_Stop(_dataPushTimerRef);
-			le_timer_SetInterval(_dataPushTimerRef, interval);
-			le_timer_Start(_dataPushTimerRef);
+			//only the samples in the record are batched : an acknowledged push is their receipt
+			BatchSample(&samplesPtr[i]);
+			tickBytes += GetSampleBytes(&samplesPtr[i]);
+			i++;
+		}
+		else if (((LE_NO_MEMORY == result) || (LE_OVERFLOW == result)) && _batchPtr->count)
+		{
+			//the record is full : it goes with the part of the tick it holds, the sample is recorded again in a new one
+			if (tickBytes > TIMESERIE_TIMESTAMP_BYTES)
+			{
+				_recordCount++;
+				_recordBytes += tickBytes;
+				tickBytes = TIMESERIE_TIMESTAMP_BYTES;
+			}
+
+			CloseTimeserie();
 		}
 		else
 		{
-			LE_INFO("Setting Change: DataPushInterval is unchanged: %d seconds", _dataPushInterval);
+			//not even in an empty record, kept on flash
+			LE_WARN("Sample %u cannot be recorded (%d), kept on flash", samplesPtr[i].resourceId, result);
+			store_Append(&samplesPtr[i], 1);
+			i++;
 		}
 	}
-	else if (strstr(path, FIELDNAME_AC_TARGET_TEMP) != NULL)
-	{
-		LE_INFO("Setting Change: AC-Temperature was %f C°", _temperatureTarget);
-		le_avdata_GetFloat(SETTING_TEMP_TARGET, &_temperatureTarget);               //Get the new setting from AirVantage
 
-		LE_INFO("Setting Change: AC-Temperature is now %f C°", _temperatureTarget);
-        SaveConfig();
+	if (NULL == _recordRef)
+	{
+		return;
 	}
-	else if (strstr(path, FIELDNAME_AIR_TEMP) != NULL)
+
+	if (tickBytes > TIMESERIE_TIMESTAMP_BYTES)
 	{
-		LE_INFO("Setting Change: Air Temperature was %d C°", _temperatureOutside);
-		le_avdata_GetInt(SETTING_TEMP_AIR, &_temperatureOutside);               //Get the new setting from AirVantage
+		_recordCount++;
+		_recordBytes += tickBytes;
+	}
+
+	trace_Add(TRACE_ACCUMULATE, count, _recordCount, _recordBytes);
 
-		LE_INFO("Setting Change: Air Temperature is now %d C°", _temperatureOutside);
-		SaveConfig();
+	//as many bytes are expected next time
+	//once the uplink is stalled or the radio poor, the samples keep on merging into the held timeserie until it is full
+	if (((_recordBytes + tickBytes) > (size_t)_batchBytes) ||
+		((_batchPtr->count + TIMESERIE_MAX_TICK_SAMPLES) > TIMESERIE_MAX_SAMPLES))
+	{
+		CloseTimeserie();
 	}
-	else if (strstr(path, FIELDNAME_MANGOH_TYPE) != NULL)
+}
+
+//Function to accumulate the current temperature and fan duration of every compartment in a timeserie record, in raw mode
+//In report-by-exception mode, a value is only recorded when it moved out of its deadband, or once per heartbeat
+void Accumulate()
+{
+	uint64_t		utcMilliSec = GetUtcMilliSec();
+	store_Sample_t	samples[2 * ZONE_MAX_COUNT];
+	size_t			count = 0;
+	bool			checkDeadbands = _reportByException && _samplesReported && !IsHeartbeatDue(_samplesReportTime);
+	bool			recordAll = true;
+	int				zone;
+
+	for (zone = 0; zone < _zoneCount; zone++)
 	{
-		LE_INFO("Setting Change: mangOH board type was %d (0 = Red, 1 = Green, 2=Yellow)", _mangohBoardType);
-		int	value;
-		le_avdata_GetInt(SETTING_MANGOH_TYPE, &value);               //Get the new setting from AirVantage
+		double	temperature = _zones.temperature[zone];
+		int		fanDuration = _zones.fanDuration[zone];
+		bool	recordTemperature = !checkDeadbands || (fabs(temperature - _reportedZones.temperature[zone]) > _tempDeadband);
+		bool	recordFanDuration = !checkDeadbands || (abs(fanDuration - _reportedZones.fanDuration[zone]) >= _durationDeadband);
+
+		if (recordTemperature)
+		{
+			samples[count++] = (store_Sample_t){ utcMilliSec, SAMPLE_ID(zone, SAMPLE_TEMP_CURRENT), temperature };
+			_reportedZones.temperature[zone] = temperature;
+		}
 
-		_mangohBoardType = value;
-		gpio_iot_SetMangohType(_mangohBoardType);
+		if (recordFanDuration)
+		{
+			samples[count++] = (store_Sample_t){ utcMilliSec, SAMPLE_ID(zone, SAMPLE_FAN_DURATION), fanDuration };
+			_reportedZones.fanDuration[zone] = fanDuration;
+		}
+
+		recordAll = recordAll && recordTemperature && recordFanDuration;
+	}
 
-		LE_INFO("Setting Change: mangOH board type is now %d (0 = Red, 1 = Green, 2=Yellow)", _mangohBoardType);
-		SaveConfig();
+	if (recordAll)
+	{
+		_samplesReported = true;
+		_samplesReportTime = le_clk_GetRelativeTime().sec;
 	}
-	
+
+	AccumulateSamples(samples, count);
 }
 
-//Callback function to handle Command Execution Request from AV
-void OnCommand
-(
-	const char* path,
-    le_avdata_AccessType_t accessType,
-    le_avdata_ArgumentListRef_t argumentList,
-    void* contextPtr
-)
+//Window job, every aggregate.window seconds : record the summary of the window of every compartment in the timeserie, then start a new window
+//the temperature is summarized (last, min, max, mean, count), the fan duration is a counter, its last value is enough
+static void SummarizeWindow(void* contextPtr)
 {
-	LE_INFO("*** OnCommand *** : %s", path);
+	uint64_t		utcMilliSec = GetUtcMilliSec();
+	store_Sample_t	samples[TIMESERIE_MAX_TICK_SAMPLES];
+	size_t			count = 0;
+	int				zone;
 
-	if (strstr(path, FIELDNAME_START_FAN) != NULL)
+	for (zone = 0; zone < ZONE_MAX_COUNT; zone++)
 	{
-		LE_INFO("Execute Command Request: StartFan");
-		SwitchFan(true, true);
+		aggregate_Window_t* windowPtr = &_temperatureWindows[zone];
+
+		//a compartment no longer in use drops its window
+		if ((zone < _zoneCount) && windowPtr->count)
+		{
+			samples[count++] = (store_Sample_t){ utcMilliSec, SAMPLE_ID(zone, SAMPLE_TEMP_CURRENT), windowPtr->last };
+			samples[count++] = (store_Sample_t){ utcMilliSec, SAMPLE_ID(zone, SAMPLE_TEMP_MIN), windowPtr->min };
+			samples[count++] = (store_Sample_t){ utcMilliSec, SAMPLE_ID(zone, SAMPLE_TEMP_MAX), windowPtr->max };
+			samples[count++] = (store_Sample_t){ utcMilliSec, SAMPLE_ID(zone, SAMPLE_TEMP_MEAN), aggregate_GetMean(windowPtr) };
+			samples[count++] = (store_Sample_t){ utcMilliSec, SAMPLE_ID(zone, SAMPLE_TEMP_COUNT), windowPtr->count };
+			samples[count++] = (store_Sample_t){ utcMilliSec, SAMPLE_ID(zone, SAMPLE_FAN_DURATION), _fanDurationWindows[zone].last };
+
+			trace_Add(TRACE_WINDOW, zone, TRACE_MILLI(windowPtr->min), TRACE_MILLI(windowPtr->max));
+		}
+
+		aggregate_Reset(windowPtr);
+		aggregate_Reset(&_fanDurationWindows[zone]);
 	}
-	else if (strstr(path, FIELDNAME_STOP_FAN) != NULL)
+
+	AccumulateSamples(samples, count);
+}
+
+//Flush job, every batch.latency seconds : push the current timeserie, none of its samples is older than the latency
+//while the radio is poor it is held, and goes with the first flush after the radio improved
+static void FlushTimeserie(void* contextPtr)
+{
+	if (_recordRef && CanPushTimeserie())
 	{
-		LE_INFO("Execute Command Request: StopFan");
-		SwitchFan(false, true);
+		PushTimeserie();
 	}
-	else if (strstr(path, FIELDNAME_OPEN_DOOR) != NULL)
+}
+
+//Flush handler, the session is back or the uplink is no longer stalled : push in one burst what was held meanwhile, then catch up with the stored samples
+static void OnSessionFlush(void* contextPtr)
+{
+	if (_pendingState)
 	{
-		LE_INFO("Execute Command Request: OpenDoor");
-		SwitchDoor(true, true);
+		PushState(_pendingState);
 	}
-	else if (strstr(path, FIELDNAME_CLOSE_DOOR) != NULL)
+
+	if (_recordRef && CanPushTimeserie())
 	{
-		LE_INFO("Execute Command Request: CloseDoor");
-		SwitchDoor(false, true);
+		PushTimeserie();
 	}
 
-	le_avdata_ReplyExecResult(argumentList, LE_OK);
+	StartReplay();
 }
 
-//Callback function to handle the timeserie push status
-void PushRecordCallbackHandler
-(
-    le_avdata_PushStatus_t status,
-    void* contextPtr
-)
+//Session stopped : avcService may drop the callbacks of the pushes in flight
+//the pushed timeseries are kept on flash for replay, and the replay goes on in the next session
+static void OnSessionStop(void* contextPtr)
 {
-    if (status == LE_AVDATA_PUSH_SUCCESS)
- 	{
- 		LE_INFO("Push Timeserie OK");
- 	}
- 	else
- 	{
- 		LE_INFO("Failed to push Timeserie");
- 	}
-}
-
+	while (_batchesInFlight)
+	{
+		TimeserieBatch_t* batchPtr = _batchesInFlight;
 
-//Function to accumulate the current temperature and fan duration in a timeserie record
-//create a new record if doesn't exist, if the number of record reach TIMESERIE_MAX_RECORD then push the serie to AV
-void Accumulate()
-{
-	struct timeval 	tv;
-    gettimeofday(&tv, NULL);
-	uint64_t	utcMilliSec = (uint64_t)(tv.tv_sec) * 1000 + (uint64_t)(tv.tv_usec) / 1000;
+		_batchesInFlight = batchPtr->nextPtr;
+		CompleteBatch(batchPtr, false);
+	}
 
-	bool		pushNow = false;
+	_replayInFlight = false;
 
-	if (_recordRef == NULL)
+	//a state push of the stopped session may never be delivered : the whole state goes once the session is back
+	if (_statePushesInFlight)
 	{
-		le_pos_FixState_t 	fixStatePtr;
-		position_PushLocation(&fixStatePtr);
-
-		LE_INFO("Creating new Record");
-		_recordRef = le_avdata_CreateRecord();
-		_recordCount = 0;
+		_pendingState |= STATE_ALL;
+		_statePushesInFlight = 0;
 	}
+}
 
-	le_result_t result = le_avdata_RecordFloat(_recordRef, VARIABLE_TEMP_CURRENT, _temperature, utcMilliSec);
-	result = le_avdata_RecordInt(_recordRef, VARIABLE_FAN_DURATION, _fanDuration, utcMilliSec);
+//true if every compartment has its door closed and sits at the temp it converges to : nothing to report until an event
+static bool IsStable()
+{
+	int zone;
 
-	if (LE_OK == result)
+	for (zone = 0; zone < _zoneCount; zone++)
 	{
-		_recordCount++;
+		double convergedTo = _zones.fanIsOn[zone] ? _zones.temperatureTarget[zone] : (double)_temperatureOutside;
 
-		if (_recordCount >= TIMESERIE_MAX_RECORD)
+		if (_zones.doorIsOpen[zone] || (fabs(_zones.temperature[zone] - convergedTo) > _tempDeadband))
 		{
-			pushNow = true;
+			return false;
 		}
 	}
-	else if (result == LE_NO_MEMORY || result == LE_OVERFLOW)
-    {
-        LE_INFO("Buffer Overflow or Full, Now Pushing timeseries");
-        
-        pushNow = true;       
-	}
-	else
-	{
-		LE_INFO("Unknown Accumulation outcome");
-	}
-
-	if (pushNow)
-	{
-		result = le_avdata_PushRecord(_recordRef, PushRecordCallbackHandler, NULL);
 
-        if (LE_OK != result)
-        {
-        	LE_INFO("Failed pushing timeseries");
-        }
-        //else if (LE_OK == result)		//discard anyway even push failed
-        {
-        	le_avdata_DeleteRecord(_recordRef);
-        	_recordRef = NULL;
-        } 
-	}
+	return true;
 }
 
-//Converge a temperature to a given target temp
-void converge(double target, double step, double* value)
+//wake cycle of the low-power mode : the state and everything held since the last wakeup are pushed in one burst
+static void FlushWakeCycle()
 {
-    if (*value < target)
-    {
-        *value += step;
-    }
-    else
-    {
-        *value -= step;
-    }
+	if (!_aggregateRaw)
+	{
+		SummarizeWindow(NULL);
+	}
+
+	pushData(NULL);
+	OnSessionFlush(NULL);
 }
 
-//Simulate the envisaged scenario (refer to header of this file)
-void emulate(le_timer_Ref_t  timerRef)
+//Simulate the envisaged scenario (refer to header of this file), for every compartment
+void emulate(void* contextPtr)
 {
-	if (_fanIsOn && !_doorIsOpen)
+    le_clk_Time_t   startTime = le_clk_GetRelativeTime();
+    double          targets[ZONE_MAX_COUNT];
+    int             zone;
+
+    //if door is closed and fan is on then converge to target temp, otherwise converge to outside temp
+    //the model is advanced by the time elapsed since the last tick, whatever the interval or a suspend in between
+    AdvanceZones(targets);
+
+    for (zone = 0; zone < _zoneCount; zone++)
     {
-        //if door is closed and fan is on then converge to target temp
-        converge(_temperatureTarget, TEMPERATURE_INC_STEP, &_temperature);
-        
-        LE_INFO("Converging to Target temp (%f °C) - Current temperature = %f", _temperatureTarget, _temperature);
+        double temperature = _zones.temperature[zone];
 
-        if (_temperature <= _temperatureTarget)
+        trace_Add(TRACE_EMULATE, zone, TRACE_MILLI(temperature), TRACE_MILLI(targets[zone]));
+
+        le_avdata_SetFloat(_samplePaths[zone][SAMPLE_TEMP_CURRENT], temperature);
+        le_avdata_SetInt(_samplePaths[zone][SAMPLE_FAN_DURATION], _zones.fanDuration[zone]);
+
+        if (!_aggregateRaw)
         {
-            LE_INFO("Reach Target temp, turning off Fan");
-            SwitchFan(false, true);   //reach target temp, turn off Fan
+            aggregate_Add(&_temperatureWindows[zone], temperature);
+            aggregate_Add(&_fanDurationWindows[zone], _zones.fanDuration[zone]);
         }
     }
-    else
-    {
-        //otherwise, converge to outside temp
-        converge((double)_temperatureOutside, TEMPERATURE_INC_STEP, &_temperature);
 
-        LE_INFO("Converging to Outside temp (%d °C) - Current temperature = %f", _temperatureOutside, _temperature);
+    if (_aggregateRaw)
+    {
+        Accumulate();
     }
 
-    if (_fanIsOn)
+    //the sample above goes along with the alarm, if any
+    CheckTemperatureAlarm();
+
+    //low-power mode : sleep until the next sample while nothing changes, one uplink per wake cycle
+    SetSleeping(_lowPower && IsStable());
+
+    if (_sleeping)
     {
-        _fanDuration += FAN_DURATION_INC_STEP;
+        FlushWakeCycle();
     }
 
-    le_avdata_SetFloat(VARIABLE_TEMP_CURRENT, _temperature);
-    le_avdata_SetInt(VARIABLE_FAN_DURATION, _fanDuration);
-
-    Accumulate();
+    diag_AddTick(startTime);
 }
 
-//callback function to handle the door push button transition : just toggle the door status
+//callback function to handle the door push button transition : just toggle the door status of compartment 0
 static void OnDoorSwitchChangeCallback(bool state, void *ctx)
 {
-    LE_INFO("Door State change %s", state?"TRUE":"FALSE");
+    trace_Add(TRACE_DOOR_SWITCH, state, 0, 0);
 
-    bool output = gpio_iot_Read(GPIO_PIN_DOOR_LED);
+    //wake up right away, the door switch is the wakeup source of the low-power mode
+    WakeUp();
 
-    SwitchDoor(!output, true);
+    //the LED shows the door state, which is known without reading the LED back
+    SwitchDoor(0, !_zones.doorIsOpen[0], true);
 }
 
 //Setting up the push button door switch assigned to GPIO_1
@@ -520,8 +2151,8 @@ void SetupDoorSwitchGpio()		//Use GPIO_1 as an Input, a push button to open/clos
 {
 	gpio_iot_SetInput(GPIO_PIN_DOOR_SWITCH, true);
 	gpio_iot_EnablePullUp(GPIO_PIN_DOOR_SWITCH);
-	//if the button is pushed, then call OnGpio1Change callback function
-	gpio_iot_AddChangeEventHandler(GPIO_PIN_DOOR_SWITCH, GPIO_IOT_EDGE_RISING, OnDoorSwitchChangeCallback, NULL, 100);
+	//if the button is pushed, then call OnGpio1Change callback function, once per push however the contact bounces
+	gpio_iot_AddDebouncedChangeEventHandler(GPIO_PIN_DOOR_SWITCH, GPIO_IOT_EDGE_RISING, OnDoorSwitchChangeCallback, NULL, DOOR_SWITCH_SETTLE_MS);
 }
 
 //Setting up the fan motor assigned to GPIO_3
@@ -541,11 +2172,13 @@ static void sig_appTermination_cbh(int sigNum)
 {
 	position_Stop();
 
-	if (_truck_requestSessionRef)
-	{
-        //Release the session with AirVantage
-		le_avdata_ReleaseSession(_truck_requestSessionRef);
-	}
+	store_Close();
+
+	//do not lose the settings changed just before exiting
+	FlushConfig();
+
+	//Release the session with AirVantage
+	session_Stop();
 }
 
 //main start
@@ -556,17 +2189,40 @@ COMPONENT_INIT
 	le_sig_Block(SIGTERM);
 	le_sig_SetEventHandler(SIGTERM, sig_appTermination_cbh);
 
-    //Open a session with AirVantage
-	_truck_requestSessionRef = le_avdata_RequestSession();
+    //Open the store of the samples to be replayed, before the session may start
+	_batchPool = le_mem_CreatePool("TimeserieBatch", sizeof(TimeserieBatch_t));
+	le_mem_ExpandPool(_batchPool, 2);
+	le_result_t storeResult = store_Open(SAMPLE_STORE_PATH, SAMPLE_STORE_CAPACITY);
+
+	_storeOpened = (LE_OK == storeResult);
+	LE_ERROR_IF(!_storeOpened, "Cannot open the sample store %s (%d) : no replay, the timeseries are no longer held for the radio",
+				SAMPLE_STORE_PATH, storeResult);
 
-	//retrieve default settings from config tree
+	//replay job is suspended until there is something to replay
+	_replayJobRef = scheduler_AddJob("replay", 0, ReplayStoredSamples, NULL);
+
+    //Open a session with AirVantage, what is held while it is down is pushed when it starts
+	session_AddFlushHandler(OnSessionFlush, NULL);
+	session_AddStopHandler(OnSessionStop, NULL);
+	session_Start();
+
+	//retrieve default settings from config tree, the compartments hold the defaults of their settings
+	InitZones();
     LoadConfig();
 
     //data path is not prefixed by application name
 	le_avdata_SetNamespace(LE_AVDATA_NAMESPACE_GLOBAL);
 
-	//Start positioning service
+	session_SetMaxInFlight(_maxInFlight);
+	ApplyUplink(0);
+
+	//slow service calls (config tree commits, GNSS reads) are run off the main thread from now on
+	worker_Start();
+
+	//Start positioning service, the location is refreshed when the truck moves
+	position_SetMovementThresholds(_gnssHDistance, _gnssVDistance);
 	position_Start();
+	position_SetFixInterval(_lowPower ? _fixInterval : 0);
 
 	//Setup GPIOs
 	gpio_iot_Init();
@@ -575,88 +2231,27 @@ COMPONENT_INIT
 	SetupDoorLedGpio();
 	SetupDoorSwitchGpio();
 
-	//Create Variables
-	le_avdata_CreateResource(VARIABLE_FAN_STATE, LE_AVDATA_ACCESS_VARIABLE);
-    SwitchFan(_fanIsOn, false);
-
-    le_avdata_CreateResource(VARIABLE_FAN_DURATION, LE_AVDATA_ACCESS_VARIABLE);
-    le_avdata_SetInt(VARIABLE_FAN_DURATION, _fanDuration);
-
-    le_avdata_CreateResource(VARIABLE_TEMP_CURRENT, LE_AVDATA_ACCESS_VARIABLE);
-    le_avdata_SetFloat(VARIABLE_TEMP_CURRENT, _temperature);
-
-    le_avdata_CreateResource(VARIABLE_DOOR_STATE, LE_AVDATA_ACCESS_VARIABLE);
-    SwitchDoor(_doorIsOpen, false);
-
-
-    //Create Settings
-    le_avdata_CreateResource(SETTING_DATAGEN_INTERVAL, LE_AVDATA_ACCESS_SETTING);
-    le_avdata_SetInt(SETTING_DATAGEN_INTERVAL, _dataGenInterval);
-    le_avdata_AddResourceEventHandler(SETTING_DATAGEN_INTERVAL, OnWriteSetting, NULL);
-
-    le_avdata_CreateResource(SETTING_DATAPUSH_INTERVAL, LE_AVDATA_ACCESS_SETTING);
-    le_avdata_SetInt(SETTING_DATAPUSH_INTERVAL, _dataPushInterval);
-    le_avdata_AddResourceEventHandler(SETTING_DATAPUSH_INTERVAL, OnWriteSetting, NULL);
-
-    le_avdata_CreateResource(SETTING_TEMP_TARGET, LE_AVDATA_ACCESS_SETTING);
-    le_avdata_SetFloat(SETTING_TEMP_TARGET, _temperatureTarget);
-    le_avdata_AddResourceEventHandler(SETTING_TEMP_TARGET, OnWriteSetting, NULL);
-
-    le_avdata_CreateResource(SETTING_TEMP_AIR, LE_AVDATA_ACCESS_SETTING);
-    le_avdata_SetInt(SETTING_TEMP_AIR, _temperatureOutside);
-    le_avdata_AddResourceEventHandler(SETTING_TEMP_AIR, OnWriteSetting, NULL);
-
-    le_avdata_CreateResource(SETTING_MANGOH_TYPE, LE_AVDATA_ACCESS_SETTING);
-    le_avdata_SetInt(SETTING_MANGOH_TYPE, _mangohBoardType);
-    le_avdata_AddResourceEventHandler(SETTING_MANGOH_TYPE, OnWriteSetting, NULL);
-    
-
-
-    //Create Command
-    le_avdata_CreateResource(COMMAND_FAN_START, LE_AVDATA_ACCESS_COMMAND);
-    le_avdata_AddResourceEventHandler(COMMAND_FAN_START, OnCommand, NULL);
-
-    le_avdata_CreateResource(COMMAND_FAN_STOP, LE_AVDATA_ACCESS_COMMAND);
-    le_avdata_AddResourceEventHandler(COMMAND_FAN_STOP, OnCommand, NULL);
-
-    le_avdata_CreateResource(COMMAND_OPEN_DOOR, LE_AVDATA_ACCESS_COMMAND);
-    le_avdata_AddResourceEventHandler(COMMAND_OPEN_DOOR, OnCommand, NULL);
-
-    le_avdata_CreateResource(COMMAND_CLOSE_DOOR, LE_AVDATA_ACCESS_COMMAND);
-    le_avdata_AddResourceEventHandler(COMMAND_CLOSE_DOOR, OnCommand, NULL);
-
-    
-  
-	//Set timer to update/simulate data on a regularyly basis
-	_dataGenTimerRef = le_timer_Create("dataGenTimer");     //create timer
-
-	le_clk_Time_t      interval = { _dataGenInterval, 0 };                      //update temperature every 5 seconds
-	le_timer_SetInterval(_dataGenTimerRef, interval);
-	le_timer_SetRepeat(_dataGenTimerRef, 0);                   //set repeat to always
-
-	//set callback function to handle timer expiration event
-	le_timer_SetHandler(_dataGenTimerRef, emulate);
-
-	emulate(_dataGenTimerRef);
-
-	//start timer
-	le_timer_Start(_dataGenTimerRef);
-
+	//Create Variables, Settings and Commands
+	CreateResources();
+	diag_Init();
 
+	//drive the actuators from the initial state
+	SwitchFan(0, _zones.fanIsOn[0], false);
+	SwitchDoor(0, _zones.doorIsOpen[0], false);
 
-	//Set timer to create and push timeSerie
-	_dataPushTimerRef = le_timer_Create("dataPushTimer");     //create timer
+	//Periodic jobs share a single timer, the data generation runs before the push when both are due
+	_thermalTime = GetBootSec();
+	emulate(NULL);
+	_dataGenJobRef = scheduler_AddJob("dataGen", _dataGenInterval, emulate, NULL);
 
-	le_clk_Time_t      interval2 = { _dataPushInterval, 0 };                      //update temperature every 5 seconds
-	le_timer_SetInterval(_dataPushTimerRef, interval2);
-	le_timer_SetRepeat(_dataPushTimerRef, 0);                   //set repeat to always
+	pushData(NULL);
+	_dataPushJobRef = scheduler_AddJob("dataPush", _dataPushInterval, pushData, NULL);
 
-	//set callback function to handle timer expiration event
-	le_timer_SetHandler(_dataPushTimerRef, pushData);
+	//the window summary runs after the samples of the window were generated, and before the flush
+	_aggregateJobRef = scheduler_AddJob("aggregate", _aggregateRaw ? 0 : _aggregateWindow, SummarizeWindow, NULL);
 
-	pushData(_dataPushTimerRef);
+	_flushJobRef = scheduler_AddJob("flush", _batchLatency, FlushTimeserie, NULL);
 
-	//start timer
-	le_timer_Start(_dataPushTimerRef);
+	_diagJobRef = scheduler_AddJob("diag", (_diagInterval > 0) ? _diagInterval : 0, diag_Publish, NULL);
 
 }
@@ -7,6 +7,10 @@
  *  You don't need to figure out which le_gpioPinxxx function to be used to address a physical GPIO in on the IoT0 card.
  *  Your app can run on mangOH Green or Red without changing the code nor IoTcard wiring.
  *
+ *  The pin map (IoT slot, GPIO) -> CF3 pin is loaded from Config Tree (/gpio_iot/pinMap/iot<slot>/gpio<n>) over the default
+ *  map of the board, into a flat table of pre-resolved le_gpioPinxx functions : a pin handle is an index in this table.
+ *  A board variant is brought up by the config alone, as long as its CF3 pins are in _gpio_cf3Pins (bound in the adef).
+ *
  *  NC - March 2018
  */
 //-------------------------------------------------------------------------------------------------
@@ -15,20 +19,25 @@
 #include "interfaces.h"
 
 #include "gpio_iot.h"
+#include "trace.h"
 
 //specify the type of mangOH board in config tree : 0=mangOH-Red, 1=mangOH-Green
 #define CONFIG_TREE_MANGOH_BOARD_INT				"/gpio_iot/mangohType"
 
 //mangOH IOT card only handle up to 4 CF3-GPIO
 #define MAX_GPIO_COUNT      4
+#define GPIO_IOT_MASK_ALL   ((1u << MAX_GPIO_COUNT) - 1)
+
+//highest CF3 pin# of the pin table
+#define MAX_CF3_PIN_NUMBER  63
+
+//pin map in config tree : CF3 pin# of each GPIO, 0 if not wired
+#define CONFIG_TREE_PIN_MAP_FORMAT                  "/gpio_iot/pinMap/iot%u/gpio%u"
+#define CONFIG_TREE_PATH_MAX                        64
 
 //3 known type for the time being
 #define MANGOH_TYPE_COUNT   GPIO_IOT_MANGOH_YELLOW+1
 
-//macro to map to the proper le_gpio API depending of the CF3-GPIO-Pin#, 3 mappings : Red, Green, Yellow
-#define LE_GPIO_FUNC(RedCf3Pin, GreenCf3Pin, YellowCf3Pin, Name)  \
-        {RedCf3Pin, le_gpioPin ## RedCf3Pin ## _ ## Name}, {GreenCf3Pin, le_gpioPin ## GreenCf3Pin ## _ ## Name}, {YellowCf3Pin, le_gpioPin ## YellowCf3Pin ## _ ## Name}
-
 //redefining generic polarity
 typedef enum
 {
@@ -36,18 +45,6 @@ typedef enum
     GPIO_IOT_ACTIVE_LOW = 1
 } gpio_iot_Polarity_t;
 
-//for the mapping
-typedef struct 
-{
-    int     cf3GpioPinNumber;
-    void*   leGpioPtr;
-} gpio_le_function_t;
-
-typedef struct {
-    const char*             functionNamePtr;
-    gpio_le_function_t      gpioFunctionPtr[MAX_GPIO_COUNT][MANGOH_TYPE_COUNT];
-} gpio_Function_t;
-
 //callbacks definition
 typedef bool (* pfnNoArgRetBool)();
 typedef gpio_iot_Polarity_t (* pfnNoArgRetPolarity)();
@@ -61,121 +58,232 @@ typedef gpio_iot_Edge_t (* pfnNoArgRetEdge)();
 //board names
 const char*   _gpio_mangoh_board[] = {"mangOH Red", "mangOH Green", "mangOH Yellow"};
 
-//Actual mapping to le_gpio api
-gpio_Function_t       _gpio_functions[] = {
-    {
-        .functionNamePtr = "Read",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, Read)},   //mapping le_gpio_Read function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, Read)},   //mapping le_gpio_Read function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, Read)},     //mapping le_gpio_Read function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, Read)}       //mapping le_gpio_Read function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
-    },
-    {
-        .functionNamePtr = "IsInput",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, IsInput)},   //mapping le_gpio_IsInput function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, IsInput)},   //mapping le_gpio_IsInput function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, IsInput)},     //mapping le_gpio_IsInput function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, IsInput)}       //mapping le_gpio_IsInput function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
-    },
-    {
-        .functionNamePtr = "GetPolarity",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, GetPolarity)},   //mapping le_gpio_GetPolarity function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, GetPolarity)},   //mapping le_gpio_GetPolarity function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, GetPolarity)},     //mapping le_gpio_GetPolarity function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, GetPolarity)}       //mapping le_gpio_GetPolarity function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
-    },
-    {
-        .functionNamePtr = "GetPullUpDown",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, GetPullUpDown)},   //mapping le_gpio_GetPullUpDown function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, GetPullUpDown)},   //mapping le_gpio_GetPullUpDown function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, GetPullUpDown)},     //mapping le_gpio_GetPullUpDown function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, GetPullUpDown)}       //mapping le_gpio_GetPullUpDown function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
-    },
-    {
-        .functionNamePtr = "SetPushPullOutput",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, SetPushPullOutput)},   //mapping le_gpio_SetPushPullOutput function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, SetPushPullOutput)},   //mapping le_gpio_SetPushPullOutput function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, SetPushPullOutput)},     //mapping le_gpio_SetPushPullOutput function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, SetPushPullOutput)}       //mapping le_gpio_SetPushPullOutput function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
-    },
-    {
-        .functionNamePtr = "Activate",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, Activate)},   //mapping le_gpio_Activate function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, Activate)},   //mapping le_gpio_Activate function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, Activate)},     //mapping le_gpio_Activate function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, Activate)}       //mapping le_gpio_Activate function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
-    },
-    {
-        .functionNamePtr = "Deactivate",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, Deactivate)},   //mapping le_gpio_Deactivate function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, Deactivate)},   //mapping le_gpio_Deactivate function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, Deactivate)},     //mapping le_gpio_Deactivate function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, Deactivate)}       //mapping le_gpio_Deactivate function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
-    },
-    {
-        .functionNamePtr = "SetInput",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, SetInput)},   //mapping le_gpio_SetInput function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, SetInput)},   //mapping le_gpio_SetInput function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, SetInput)},     //mapping le_gpio_SetInput function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, SetInput)}       //mapping le_gpio_SetInput function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
-    },
-    {
-        .functionNamePtr = "AddChangeEventHandler",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, AddChangeEventHandler)},   //mapping le_gpio_AddChangeEventHandler function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, AddChangeEventHandler)},   //mapping le_gpio_AddChangeEventHandler function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, AddChangeEventHandler)},     //mapping le_gpio_AddChangeEventHandler function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, AddChangeEventHandler)}       //mapping le_gpio_AddChangeEventHandler function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
-    },
-    {
-        .functionNamePtr = "EnablePullUp",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, EnablePullUp)},   //mapping le_gpio_EnablePullUp function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, EnablePullUp)},   //mapping le_gpio_EnablePullUp function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, EnablePullUp)},     //mapping le_gpio_EnablePullUp function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, EnablePullUp)}       //mapping le_gpio_EnablePullUp function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
-    },
-    {
-        .functionNamePtr = "EnablePullDown",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, EnablePullDown)},   //mapping le_gpio_EnablePullDown function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, EnablePullDown)},   //mapping le_gpio_EnablePullDown function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, EnablePullDown)},     //mapping le_gpio_EnablePullDown function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, EnablePullDown)}       //mapping le_gpio_EnablePullDown function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
-    },
-    {
-        .functionNamePtr = "GetEdgeSense",
-        .gpioFunctionPtr =  {
-                                {LE_GPIO_FUNC(42, 42, 42, GetEdgeSense)},   //mapping le_gpio_GetEdgeSense function for GPIO_1 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(13, 33, 13, GetEdgeSense)},   //mapping le_gpio_GetEdgeSense function for GPIO_2 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(7, 13, 7, GetEdgeSense)},     //mapping le_gpio_GetEdgeSense function for GPIO_3 (mRed, mGreen , mYellow)
-                                {LE_GPIO_FUNC(8, 8, 8, GetEdgeSense)}       //mapping le_gpio_GetEdgeSense function for GPIO_4 (mRed, mGreen , mYellow)
-                            }
+//le_gpioPinxx functions of a CF3 pin bound to the app
+typedef struct
+{
+    int                                 cf3GpioPinNumber;
+    pfnNoArgRetBool                     read;
+    pfnNoArgRetBool                     isInput;
+    pfnNoArgRetPolarity                 getPolarity;
+    pfnNoArgRetPullUpDown               getPullUpDown;
+    pfnIntBoolRetleresult               setPushPullOutput;
+    pfnNoArgRetleresult                 activate;
+    pfnNoArgRetleresult                 deactivate;
+    pfnIntRetleresult                   setInput;
+    pfnIntCbCtxtIntRetChangeEventhRef   addChangeEventHandler;
+    pfnNoArgRetleresult                 enablePullUp;
+    pfnNoArgRetleresult                 enablePullDown;
+    pfnNoArgRetEdge                     getEdgeSense;
+} gpio_Cf3Pin_t;
+
+//entry of the CF3 pin table, for the le_gpioPinN interface of the component
+#define GPIO_CF3_PIN(N)                                                                                 \
+    [N] = {                                                                                             \
+        N,                                                                                              \
+        (pfnNoArgRetBool) le_gpioPin ## N ## _Read,                                                     \
+        (pfnNoArgRetBool) le_gpioPin ## N ## _IsInput,                                                  \
+        (pfnNoArgRetPolarity) le_gpioPin ## N ## _GetPolarity,                                          \
+        (pfnNoArgRetPullUpDown) le_gpioPin ## N ## _GetPullUpDown,                                      \
+        (pfnIntBoolRetleresult) le_gpioPin ## N ## _SetPushPullOutput,                                  \
+        (pfnNoArgRetleresult) le_gpioPin ## N ## _Activate,                                             \
+        (pfnNoArgRetleresult) le_gpioPin ## N ## _Deactivate,                                           \
+        (pfnIntRetleresult) le_gpioPin ## N ## _SetInput,                                               \
+        (pfnIntCbCtxtIntRetChangeEventhRef) le_gpioPin ## N ## _AddChangeEventHandler,                  \
+        (pfnNoArgRetleresult) le_gpioPin ## N ## _EnablePullUp,                                         \
+        (pfnNoArgRetleresult) le_gpioPin ## N ## _EnablePullDown,                                       \
+        (pfnNoArgRetEdge) le_gpioPin ## N ## _GetEdgeSense                                              \
     }
+
+//CF3 pins bound to the app, indexed by CF3 pin# : a pin added here needs its le_gpioPinN api in Component.cdef and its binding in the adef
+static const gpio_Cf3Pin_t          _gpio_cf3Pins[MAX_CF3_PIN_NUMBER + 1] =
+{
+    GPIO_CF3_PIN(7),
+    GPIO_CF3_PIN(8),
+    GPIO_CF3_PIN(13),
+    GPIO_CF3_PIN(33),
+    GPIO_CF3_PIN(42),
+};
+
+//default map of IoT slot 0 : CF3 pin# of GPIO_1 to GPIO_4, for each board (mRed, mGreen , mYellow). The other slots are not wired by default
+static const int                    _gpio_boardMaps[MANGOH_TYPE_COUNT][MAX_GPIO_COUNT] =
+{
+    [GPIO_IOT_MANGOH_RED] =     { 42, 13, 7, 8 },
+    [GPIO_IOT_MANGOH_GREEN] =   { 42, 33, 13, 8 },
+    [GPIO_IOT_MANGOH_YELLOW] =  { 42, 13, 7, 8 }
 };
 
 
+//validity flags of the shadow state of a pin
+#define SHADOW_DIRECTION    0x01
+#define SHADOW_POLARITY     0x02
+#define SHADOW_PULL         0x04
+#define SHADOW_LEVEL        0x08
+#define SHADOW_EDGE         0x10
+
+//le_gpio functions of one IoT GPIO, resolved once for the selected mangOH board
+typedef struct gpio_iot_Pin
+{
+    uint32_t                            slot;
+    uint32_t                            gpioNumber;
+    int                                 cf3GpioPinNumber;
+    pfnNoArgRetBool                     read;
+    pfnNoArgRetBool                     isInput;
+    pfnNoArgRetPolarity                 getPolarity;
+    pfnNoArgRetPullUpDown               getPullUpDown;
+    pfnIntBoolRetleresult               setPushPullOutput;
+    pfnNoArgRetleresult                 activate;
+    pfnNoArgRetleresult                 deactivate;
+    pfnIntRetleresult                   setInput;
+    pfnIntCbCtxtIntRetChangeEventhRef   addChangeEventHandler;
+    pfnNoArgRetleresult                 enablePullUp;
+    pfnNoArgRetleresult                 enablePullDown;
+    pfnNoArgRetEdge                     getEdgeSense;
+
+    //shadow copy of the pin state as last configured/driven by the app, valid fields are flagged in shadowFlags
+    uint32_t                            shadowFlags;
+    bool                                bInput;
+    bool                                bActiveHigh;
+    gpio_iot_PullUpDown_t               pull;
+    bool                                bLevel;             //output only, an input level is always sampled
+    gpio_iot_Edge_t                     edge;
+} gpio_iot_Pin_t;
+
 //Specifies the type of mangOH board being used. Due to different GPIO wiring
 gpio_iot_mangohType_t               _gpio_iot_mangohType;
+static bool                         _gpio_configLoaded = false;         //board type already read from Config Tree
+
+//Pre-resolved pins, indexed by IoT slot and GPIO pin# - 1. Handles returned by gpio_iot_GetPin() point in this table
+static gpio_iot_Pin_t               _gpio_pins[GPIO_IOT_SLOT_COUNT][MAX_GPIO_COUNT];
+
+//CF3 pin# of each GPIO read from Config Tree, 0 : default map of the board
+static int                          _gpio_configMap[GPIO_IOT_SLOT_COUNT][MAX_GPIO_COUNT];
+
+//When set, getters read back from gpioService instead of the shadow state, and changes are verified
+static bool                         _gpio_verifyMode = false;
+
+//Number of calls sent to gpioService, for diagnostics
+static uint32_t                     _gpio_callCount = 0;
+
+//every call to a le_gpioPinxx function goes through this macro, so that it is counted
+#define GPIO_CALL(funcPtr)          (_gpio_callCount++, (funcPtr))
+
+//Debounce of an input : the edges restart the settle timer, the level is delivered once it stopped moving
+typedef struct
+{
+    gpio_iot_Edge_t                     trigger;            //stable transitions delivered to the handler
+    gpio_iot_ChangeCallbackFunc_t       handlerPtr;
+    void*                               contextPtr;
+    le_timer_Ref_t                      settleTimerRef;
+    bool                                bEdgeLevel;         //level reported by the last edge
+    bool                                bStableLevel;       //level last delivered
+} gpio_iot_Debounce_t;
+
+//Debounced inputs, indexed by IoT slot and GPIO pin# - 1
+static gpio_iot_Debounce_t          _gpio_debounces[GPIO_IOT_SLOT_COUNT][MAX_GPIO_COUNT];
+
+
+//CF3 pin# wired to a GPIO of an IoT slot : from Config Tree, or from the default map of the board
+static int GetCf3PinNumber(uint32_t slot, uint32_t gpioNumber)
+{
+    if (_gpio_configMap[slot][gpioNumber-1])
+    {
+        return _gpio_configMap[slot][gpioNumber-1];
+    }
+
+    return (0 == slot) ? _gpio_boardMaps[_gpio_iot_mangohType][gpioNumber-1] : 0;
+}
+
+//Resolve the le_gpioPinxx functions of every pin for the current board and pin map, so that pin accesses need no lookup
+static void ResolvePins()
+{
+    uint32_t slot;
+    uint32_t gpioNumber;
+
+    for (slot = 0; slot < GPIO_IOT_SLOT_COUNT; slot++)
+    {
+        for (gpioNumber = 1; gpioNumber <= MAX_GPIO_COUNT; gpioNumber++)
+        {
+            gpio_iot_Pin_t* pinPtr = &_gpio_pins[slot][gpioNumber-1];
+            int cf3PinNumber = GetCf3PinNumber(slot, gpioNumber);
+            const gpio_Cf3Pin_t* cf3PinPtr = NULL;
+
+            if ((cf3PinNumber > 0) && (cf3PinNumber <= MAX_CF3_PIN_NUMBER) && _gpio_cf3Pins[cf3PinNumber].read)
+            {
+                cf3PinPtr = &_gpio_cf3Pins[cf3PinNumber];
+            }
+            else if (cf3PinNumber)
+            {
+                LE_WARN("IoT%u GPIO_%u - CF3-Pin%d is not bound to the app, not wired", slot, gpioNumber, cf3PinNumber);
+            }
+
+            memset(pinPtr, 0, sizeof(*pinPtr));
+            pinPtr->slot = slot;
+            pinPtr->gpioNumber = gpioNumber;
+
+            //a GPIO not wired keeps NULL functions, gpio_iot_GetPin() answers NULL for it
+            if (cf3PinPtr)
+            {
+                pinPtr->cf3GpioPinNumber = cf3PinPtr->cf3GpioPinNumber;
+                pinPtr->read = cf3PinPtr->read;
+                pinPtr->isInput = cf3PinPtr->isInput;
+                pinPtr->getPolarity = cf3PinPtr->getPolarity;
+                pinPtr->getPullUpDown = cf3PinPtr->getPullUpDown;
+                pinPtr->setPushPullOutput = cf3PinPtr->setPushPullOutput;
+                pinPtr->activate = cf3PinPtr->activate;
+                pinPtr->deactivate = cf3PinPtr->deactivate;
+                pinPtr->setInput = cf3PinPtr->setInput;
+                pinPtr->addChangeEventHandler = cf3PinPtr->addChangeEventHandler;
+                pinPtr->enablePullUp = cf3PinPtr->enablePullUp;
+                pinPtr->enablePullDown = cf3PinPtr->enablePullDown;
+                pinPtr->getEdgeSense = cf3PinPtr->getEdgeSense;
+            }
+
+            //shadow state is cleared as well : another CF3 pin may be behind this GPIO now, its state is unknown
+        }
+    }
+}
+
+//true if the shadow state can answer for the given field without calling gpioService
+static inline bool IsShadowed(gpio_iot_PinRef_t pinRef, uint32_t flag)
+{
+    return !_gpio_verifyMode && (pinRef->shadowFlags & flag);
+}
+
+//Verify mode : read the pin state back from gpioService and report any difference with the shadow state
+static void VerifyPin(gpio_iot_PinRef_t pinRef)
+{
+    if ((pinRef->shadowFlags & SHADOW_DIRECTION) && (GPIO_CALL(pinRef->isInput)() != pinRef->bInput))
+    {
+        LE_WARN("GPIO_%d - CF3-Pin%d - direction differs from shadow", pinRef->gpioNumber, pinRef->cf3GpioPinNumber);
+    }
+
+    if ((pinRef->shadowFlags & SHADOW_POLARITY) && ((GPIO_IOT_ACTIVE_HIGH == GPIO_CALL(pinRef->getPolarity)()) != pinRef->bActiveHigh))
+    {
+        LE_WARN("GPIO_%d - CF3-Pin%d - polarity differs from shadow", pinRef->gpioNumber, pinRef->cf3GpioPinNumber);
+    }
+
+    if ((pinRef->shadowFlags & SHADOW_PULL) && (GPIO_CALL(pinRef->getPullUpDown)() != pinRef->pull))
+    {
+        LE_WARN("GPIO_%d - CF3-Pin%d - pull up/down differs from shadow", pinRef->gpioNumber, pinRef->cf3GpioPinNumber);
+    }
+
+    if ((pinRef->shadowFlags & SHADOW_LEVEL) && (GPIO_CALL(pinRef->read)() != pinRef->bLevel))
+    {
+        LE_WARN("GPIO_%d - CF3-Pin%d - output level differs from shadow", pinRef->gpioNumber, pinRef->cf3GpioPinNumber);
+    }
+}
+
+//Enable/disable the verify mode, for diagnostics
+void gpio_iot_SetVerifyMode(bool bVerify)
+{
+    _gpio_verifyMode = bVerify;
+}
+
+//Number of calls sent to gpioService since start, for diagnostics
+uint32_t gpio_iot_GetCallCount()
+{
+    return _gpio_callCount;
+}
 
 
 //return the type of board
@@ -184,67 +292,201 @@ gpio_iot_mangohType_t gpio_iot_GetMangohType()
     return _gpio_iot_mangohType;
 }
 
-//Set the type of board
+//Set the type of board, persisted by gpio_iot_SaveConfig()
 void gpio_iot_SetMangohType(gpio_iot_mangohType_t mangohType)
 {
+    if ((mangohType < 0) || (mangohType >= MANGOH_TYPE_COUNT))
+    {
+        LE_WARN("Unknown mangOH board type %d, kept %s", mangohType, _gpio_mangoh_board[_gpio_iot_mangohType]);
+        return;
+    }
+
 	_gpio_iot_mangohType = mangohType;
-    
-    //persist the setting in Config Tree
-    le_cfg_QuickSetInt(CONFIG_TREE_MANGOH_BOARD_INT, _gpio_iot_mangohType);
+
+    //board wiring changed, re-resolve the pin handles
+    ResolvePins();
 }
 
-//Return the result of the mapping to a le_gpioPin function
-gpio_le_function_t* GetFunctionPtr
-(
-    const char *    functionNamePtr,
-    uint32_t        gpioNumber
-)
+//read the type of board from Config Tree, within the read transaction of the caller. false if missing, mangOH Green is then applied
+bool gpio_iot_LoadConfig(le_cfg_IteratorRef_t txnRef)
+{
+    bool found = le_cfg_NodeExists(txnRef, CONFIG_TREE_MANGOH_BOARD_INT);
+
+    if (found)
+    {
+        int cfgValue = le_cfg_GetInt(txnRef, CONFIG_TREE_MANGOH_BOARD_INT, GPIO_IOT_MANGOH_GREEN);
+        LE_INFO("mangOH board type in Config Tree is %d", cfgValue);
+        //set the board type in the helper lib, the pins are resolved once the pin map is read
+        _gpio_iot_mangohType = ((cfgValue >= 0) && (cfgValue < MANGOH_TYPE_COUNT)) ? cfgValue : GPIO_IOT_MANGOH_GREEN;
+    }
+    else
+    {
+        LE_INFO("No setting in Config Tree, default to mangOH Green");
+        _gpio_iot_mangohType = GPIO_IOT_MANGOH_GREEN;
+    }
+
+    //the pin map overrides the default map of the board, GPIO by GPIO
+    uint32_t slot;
+    uint32_t gpioNumber;
+
+    for (slot = 0; slot < GPIO_IOT_SLOT_COUNT; slot++)
+    {
+        for (gpioNumber = 1; gpioNumber <= MAX_GPIO_COUNT; gpioNumber++)
+        {
+            char path[CONFIG_TREE_PATH_MAX];
+
+            snprintf(path, sizeof(path), CONFIG_TREE_PIN_MAP_FORMAT, slot, gpioNumber);
+            _gpio_configMap[slot][gpioNumber-1] = le_cfg_GetInt(txnRef, path, 0);
+
+            if (_gpio_configMap[slot][gpioNumber-1])
+            {
+                LE_INFO("IoT%u GPIO_%u mapped to CF3-Pin%d in Config Tree", slot, gpioNumber, _gpio_configMap[slot][gpioNumber-1]);
+            }
+        }
+    }
+
+    ResolvePins();
+
+    _gpio_configLoaded = true;
+
+    return found;
+}
+
+//persist the type of board in Config Tree, within the write transaction of the caller
+void gpio_iot_SaveConfig(le_cfg_IteratorRef_t txnRef)
+{
+    le_cfg_SetInt(txnRef, CONFIG_TREE_MANGOH_BOARD_INT, _gpio_iot_mangohType);
+}
+
+//write the given type of board to Config Tree within the write transaction of the caller, which may run on another thread
+void gpio_iot_WriteConfig(le_cfg_IteratorRef_t txnRef, gpio_iot_mangohType_t mangohType)
+{
+    le_cfg_SetInt(txnRef, CONFIG_TREE_MANGOH_BOARD_INT, mangohType);
+}
+
+//Return the handle of the provided GPIO pin# (1 - 4) of an IoT slot (0 - 2), NULL if invalid or not wired
+gpio_iot_PinRef_t gpio_iot_GetSlotPin(uint32_t slot, uint32_t gpioNumber)
 {
-    if (gpioNumber <= 0 || gpioNumber > MAX_GPIO_COUNT )
+    if (slot >= GPIO_IOT_SLOT_COUNT || gpioNumber <= 0 || gpioNumber > MAX_GPIO_COUNT )
     {
-        LE_INFO("!!!! GetFunctionPtr - Invalid GPIO Number !!!!");
+        LE_WARN("!!!! gpio_iot_GetPin - Invalid GPIO Number !!!!");
         return NULL;
     }
 
-    int functionIdx;
+    gpio_iot_PinRef_t pinRef = &_gpio_pins[slot][gpioNumber-1];
+
+    return pinRef->read ? pinRef : NULL;
+}
+
+//Return the handle of the provided IoT0-GPIO pin# (1 - 4), NULL if invalid or not wired
+gpio_iot_PinRef_t gpio_iot_GetPin(uint32_t gpioNumber)
+{
+    return gpio_iot_GetSlotPin(0, gpioNumber);
+}
+
+//Read the level of a pin through its handle : an output answers the level last driven, an input is sampled
+bool gpio_iot_PinRead(gpio_iot_PinRef_t pinRef)
+{
+    if (IsShadowed(pinRef, SHADOW_LEVEL))
+    {
+        return pinRef->bLevel;
+    }
 
-    //LE_INFO("GetFunctionPtr - looking for GPIO_%d(%s)...", gpioNumber, functionNamePtr);
+    return GPIO_CALL(pinRef->read)();
+}
 
-    for (functionIdx = 0; functionIdx < NUM_ARRAY_MEMBERS(_gpio_functions); functionIdx++)
+//Drive an output to the given level, nothing is sent to gpioService if the output is already at this level
+static le_result_t DriveOutput(gpio_iot_PinRef_t pinRef, bool bActivate)
+{
+    if ((pinRef->shadowFlags & SHADOW_LEVEL) && (pinRef->bLevel == bActivate))
     {
-        gpio_Function_t * functionPtr = &(_gpio_functions[functionIdx]);
+        return LE_OK;
+    }
 
-        //LE_INFO("Parsing %s...", functionPtr->functionNamePtr);
+    le_result_t result = bActivate ? GPIO_CALL(pinRef->activate)() : GPIO_CALL(pinRef->deactivate)();
 
-        if (strcmp(functionPtr->functionNamePtr, functionNamePtr) == 0)
-        {
-            gpio_le_function_t* pLeFunc = &functionPtr->gpioFunctionPtr[gpioNumber-1][_gpio_iot_mangohType];
+    //only an output known as such holds its level
+    if ((LE_OK == result) && (pinRef->shadowFlags & SHADOW_DIRECTION) && !pinRef->bInput)
+    {
+        pinRef->bLevel = bActivate;
+        pinRef->shadowFlags |= SHADOW_LEVEL;
+    }
 
-            //LE_INFO("Found %s... %p", functionPtr->functionNamePtr, pLeFunc);
+    if (_gpio_verifyMode)
+    {
+        VerifyPin(pinRef);
+    }
+
+    return result;
+}
+
+//Activate/Deactivate an output through its handle : direct call to le_gpioPinxx_Activate / le_gpioPinxx_Deactivate
+//Nothing is sent to gpioService if the output is already at the requested level
+void gpio_iot_PinSetOutput(gpio_iot_PinRef_t pinRef, bool bActivate)
+{
+    DriveOutput(pinRef, bActivate);
+}
+
+//Drive the outputs selected by mask (bit0 = GPIO_1) to the levels given in values, in one pass
+//Outputs already at the requested level are skipped. LE_FAULT if any output failed
+le_result_t gpio_iot_SetOutputs(uint32_t mask, uint32_t values)
+{
+    if (mask & ~GPIO_IOT_MASK_ALL)
+    {
+        LE_WARN("!!!! gpio_iot_SetOutputs - Invalid GPIO mask 0x%x !!!!", mask);
+        return LE_BAD_PARAMETER;
+    }
+
+    le_result_t result = LE_OK;
+    uint32_t    gpioNumber;
 
-            return pLeFunc;
+    for (gpioNumber = 1; gpioNumber <= MAX_GPIO_COUNT; gpioNumber++)
+    {
+        if (mask & GPIO_IOT_MASK(gpioNumber))
+        {
+            gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
+
+            if ((NULL == pinRef) || (LE_OK != DriveOutput(pinRef, (values & GPIO_IOT_MASK(gpioNumber)) != 0)))
+            {
+                result = LE_FAULT;
+            }
         }
     }
 
-    fprintf(stderr, "%s(%d) function does not exist", functionNamePtr, gpioNumber);
+    return result;
+}
+
+//Read the pins selected by mask (bit0 = GPIO_1), the level of each pin is returned in the matching bit
+uint32_t gpio_iot_ReadInputs(uint32_t mask)
+{
+    uint32_t    values = 0;
+    uint32_t    gpioNumber;
+
+    for (gpioNumber = 1; gpioNumber <= MAX_GPIO_COUNT; gpioNumber++)
+    {
+        gpio_iot_PinRef_t pinRef = (mask & GPIO_IOT_MASK(gpioNumber)) ? gpio_iot_GetPin(gpioNumber) : NULL;
+
+        if (pinRef && gpio_iot_PinRead(pinRef))
+        {
+            values |= GPIO_IOT_MASK(gpioNumber);
+        }
+    }
 
-    return NULL;
+    return values;
 }
 
 //Call the proper le_gpioPinxx_Read function based on the provided IoT0-GPIO pin# (1 - 4)
 bool gpio_iot_Read(uint32_t  gpioNumber)
 {
-    const char* name = "Read";
-    gpio_le_function_t* gpioFunctionPtr = GetFunctionPtr("Read", gpioNumber);
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
 
     bool state = false;
     
-    if (gpioFunctionPtr)
+    if (pinRef)
     {
-        pfnNoArgRetBool    pFn = (pfnNoArgRetBool) gpioFunctionPtr->leGpioPtr;
-        state = pFn();
+        state = gpio_iot_PinRead(pinRef);
 
-        LE_INFO("%s - GPIO_%d - CF3-Pin%d - %s : %d", _gpio_mangoh_board[_gpio_iot_mangohType], gpioNumber, gpioFunctionPtr->cf3GpioPinNumber, name, state);
+        trace_Add(TRACE_GPIO_READ, gpioNumber, pinRef->cf3GpioPinNumber, state);
     }
 
     return state;
@@ -253,17 +495,20 @@ bool gpio_iot_Read(uint32_t  gpioNumber)
 //Call the proper le_gpioPinxx_IsInput function based on the provided IoT0-GPIO pin# (1 - 4)
 bool gpio_iot_IsInput(uint32_t  gpioNumber)
 {
-    const char* name = "IsInput";
-    gpio_le_function_t* gpioFunctionPtr = GetFunctionPtr(name, gpioNumber);
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
 
     bool state = false;
     
-    if (gpioFunctionPtr)
+    if (pinRef)
     {
-        pfnNoArgRetBool    pFn = (pfnNoArgRetBool) gpioFunctionPtr->leGpioPtr;
-        state = pFn();
+        if (!IsShadowed(pinRef, SHADOW_DIRECTION))
+        {
+            pinRef->bInput = GPIO_CALL(pinRef->isInput)();
+            pinRef->shadowFlags |= SHADOW_DIRECTION;
+        }
+        state = pinRef->bInput;
 
-        LE_INFO("%s - GPIO_%d - CF3-Pin%d - %s : %s", _gpio_mangoh_board[_gpio_iot_mangohType], gpioNumber, gpioFunctionPtr->cf3GpioPinNumber, name, state ? "Yes" : "No");
+        trace_Add(TRACE_GPIO_IS_INPUT, gpioNumber, pinRef->cf3GpioPinNumber, state);
     }
 
     return state;
@@ -272,22 +517,22 @@ bool gpio_iot_IsInput(uint32_t  gpioNumber)
 //Call the proper le_gpioPinxx_GetPolarity function based on the provided IoT0-GPIO pin# (1 - 4)
 bool gpio_iot_GetPolarity(uint32_t  gpioNumber)
 {
-    const char* name = "GetPolarity";
-    gpio_le_function_t* gpioFunctionPtr = GetFunctionPtr(name, gpioNumber);
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
 
     bool            bPolarity = false;
     
-    if (gpioFunctionPtr)
+    if (pinRef)
     {
-        pfnNoArgRetPolarity    pFn = (pfnNoArgRetPolarity) gpioFunctionPtr->leGpioPtr;
-        gpio_iot_Polarity_t     polarity = pFn();
-
-        if (polarity == GPIO_IOT_ACTIVE_HIGH)
+        if (!IsShadowed(pinRef, SHADOW_POLARITY))
         {
-            bPolarity = true;
+            gpio_iot_Polarity_t     polarity = GPIO_CALL(pinRef->getPolarity)();
+
+            pinRef->bActiveHigh = (polarity == GPIO_IOT_ACTIVE_HIGH);
+            pinRef->shadowFlags |= SHADOW_POLARITY;
         }
+        bPolarity = pinRef->bActiveHigh;
 
-        LE_INFO("%s - GPIO_%d - CF3-Pin%d - %s : %s", _gpio_mangoh_board[_gpio_iot_mangohType], gpioNumber, gpioFunctionPtr->cf3GpioPinNumber, name, bPolarity ? "ACTIVE_HIGH" : "ACTIVE_LOW");
+        trace_Add(TRACE_GPIO_POLARITY, gpioNumber, pinRef->cf3GpioPinNumber, bPolarity);
     }
 
     return bPolarity;
@@ -296,55 +541,63 @@ bool gpio_iot_GetPolarity(uint32_t  gpioNumber)
 //Call the proper le_gpioPinxx_GetPullUpDown function based on the provided IoT0-GPIO pin# (1 - 4)
 gpio_iot_PullUpDown_t gpio_iot_GetPullUpDown(uint32_t gpioNumber)
 {
-    const char* name = "GetPullUpDown";
-    gpio_le_function_t* gpioFunctionPtr = GetFunctionPtr(name, gpioNumber);
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
 
-    if (gpioFunctionPtr)
+    if (pinRef)
     {
-        pfnNoArgRetPullUpDown    pFn = (pfnNoArgRetPullUpDown) gpioFunctionPtr->leGpioPtr;
-        gpio_iot_PullUpDown_t pud = pFn();
-
-        if (pud == GPIO_IOT_PULL_DOWN)
-        {
-            LE_INFO("%s - GPIO_%d - CF3-Pin%d - %s : %s", _gpio_mangoh_board[_gpio_iot_mangohType], gpioNumber, gpioFunctionPtr->cf3GpioPinNumber, name, "pull down");
-        }
-        else if (pud == GPIO_IOT_PULL_UP)
-        {
-            LE_INFO("%s - GPIO_%d - CF3-Pin%d - %s : %s", _gpio_mangoh_board[_gpio_iot_mangohType], gpioNumber, gpioFunctionPtr->cf3GpioPinNumber, name, "pull up");
-        }
-        else
+        if (!IsShadowed(pinRef, SHADOW_PULL))
         {
-            LE_INFO("%s - GPIO_%d - CF3-Pin%d - %s : %s", _gpio_mangoh_board[_gpio_iot_mangohType], gpioNumber, gpioFunctionPtr->cf3GpioPinNumber, name, "pull none");
+            pinRef->pull = GPIO_CALL(pinRef->getPullUpDown)();
+            pinRef->shadowFlags |= SHADOW_PULL;
         }
-        return pud;
+        gpio_iot_PullUpDown_t pud = pinRef->pull;
 
-        
+        trace_Add(TRACE_GPIO_PULL, gpioNumber, pinRef->cf3GpioPinNumber, pud);
+
+        return pud;
     }
 
     return -1;
 }
 
 
-//To Set a GPIO "As Output"
-//Call the proper le_gpioPinxx_SetPushPullOutput function based on the provided IoT0-GPIO pin# (1 - 4)
-void gpio_iot_SetPushPullOutput(uint32_t gpioNumber, bool bActiveHigh, bool bInitValue)
+//To Set a GPIO "As Output" through its handle : direct call to le_gpioPinxx_SetPushPullOutput
+//Nothing is sent to gpioService if the pin is already configured this way
+void gpio_iot_PinSetPushPullOutput(gpio_iot_PinRef_t pinRef, bool bActiveHigh, bool bInitValue)
 {
+    const uint32_t config = SHADOW_DIRECTION | SHADOW_POLARITY | SHADOW_LEVEL;
+
+    if (((pinRef->shadowFlags & config) == config) && !pinRef->bInput &&
+        (pinRef->bActiveHigh == bActiveHigh) && (pinRef->bLevel == bInitValue))
+    {
+        return;
+    }
+
     gpio_iot_Polarity_t polarity = bActiveHigh ? GPIO_IOT_ACTIVE_HIGH : GPIO_IOT_ACTIVE_LOW;
 
-    const char* name = "SetPushPullOutput";
-    gpio_le_function_t* gpioFunctionPtr = GetFunctionPtr(name, gpioNumber);
+    GPIO_CALL(pinRef->setPushPullOutput)(polarity, bInitValue);
 
-    if (gpioFunctionPtr)
-    {
-        pfnIntBoolRetleresult    pFn = (pfnIntBoolRetleresult) gpioFunctionPtr->leGpioPtr;
-        pFn(polarity, bInitValue);
+    pinRef->bInput = false;
+    pinRef->bActiveHigh = bActiveHigh;
+    pinRef->bLevel = bInitValue;
+    pinRef->shadowFlags |= config;
 
-        gpio_iot_Read(gpioNumber);
+    if (_gpio_verifyMode)
+    {
+        VerifyPin(pinRef);
+    }
+}
 
-        gpio_iot_IsInput(gpioNumber);
+//To Set a GPIO "As Output"
+//Call the proper le_gpioPinxx_SetPushPullOutput function based on the provided IoT0-GPIO pin# (1 - 4)
+void gpio_iot_SetPushPullOutput(uint32_t gpioNumber, bool bActiveHigh, bool bInitValue)
+{
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
 
+    if (pinRef)
+    {
+        gpio_iot_PinSetPushPullOutput(pinRef, bActiveHigh, bInitValue);
     }
-    
 }
 
 
@@ -352,51 +605,72 @@ void gpio_iot_SetPushPullOutput(uint32_t gpioNumber, bool bActiveHigh, bool bIni
 //Call the proper le_gpioPinxx_Activate / le_gpioPinxx_Deactivate function based on the provided IoT0-GPIO pin# (1 - 4)
 void gpio_iot_SetOutput(uint32_t gpioNumber, bool bActivate)
 {
-    char name[32] = {0};
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
 
-    if (bActivate)
+    if (pinRef)
     {
-        strcpy(name, "Activate");        
+        gpio_iot_PinSetOutput(pinRef, bActivate);
     }
-    else
+}
+
+
+
+//Set a GPIO as "an Input" through its handle : direct call to le_gpioPinxx_SetInput
+//Nothing is sent to gpioService if the pin is already configured this way
+void gpio_iot_PinSetInput(gpio_iot_PinRef_t pinRef, bool bPolarityHigh)
+{
+    const uint32_t config = SHADOW_DIRECTION | SHADOW_POLARITY;
+
+    if (((pinRef->shadowFlags & config) == config) && pinRef->bInput && (pinRef->bActiveHigh == bPolarityHigh))
     {
-        strcpy(name, "Deactivate");
+        return;
     }
 
-    gpio_le_function_t* gpioFunctionPtr = GetFunctionPtr(name, gpioNumber);
+    gpio_iot_Polarity_t polarity = bPolarityHigh ? GPIO_IOT_ACTIVE_HIGH : GPIO_IOT_ACTIVE_LOW;
 
-    if (gpioFunctionPtr)
+    GPIO_CALL(pinRef->setInput)(polarity);
+
+    pinRef->bInput = true;
+    pinRef->bActiveHigh = bPolarityHigh;
+    pinRef->shadowFlags = (pinRef->shadowFlags | config) & ~SHADOW_LEVEL;
+
+    if (_gpio_verifyMode)
     {
-        pfnNoArgRetleresult    pFn = (pfnNoArgRetleresult) gpioFunctionPtr->leGpioPtr;
-        pFn();
+        VerifyPin(pinRef);
     }
 }
 
-
-
 //Set a GPIO as "an Input"
 //Call the proper le_gpioPinxx_SetInput function based on the provided IoT0-GPIO pin# (1 - 4)
 void gpio_iot_SetInput(uint32_t gpioNumber, bool bPolarityHigh)
 {
-    const char* name = "SetInput";
-    gpio_le_function_t* gpioFunctionPtr = GetFunctionPtr(name, gpioNumber);
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
 
-    if (gpioFunctionPtr)
+    if (pinRef)
     {
-        pfnIntRetleresult    pFn = (pfnIntRetleresult) gpioFunctionPtr->leGpioPtr;
-
-        gpio_iot_Polarity_t polarity = bPolarityHigh ? GPIO_IOT_ACTIVE_HIGH : GPIO_IOT_ACTIVE_LOW;
-
-        pFn(polarity);
-
-        gpio_iot_Read(gpioNumber);
-
-        gpio_iot_IsInput(gpioNumber);
+        gpio_iot_PinSetInput(pinRef, bPolarityHigh);
+    }
+}
 
-        gpio_iot_GetPolarity(gpioNumber);
+//Set an input change handler through the handle of the pin : direct call to le_gpioPinxx_AddChangeEventHandler
+gpio_iot_ChangeEventHandlerRef_t  gpio_iot_PinAddChangeEventHandler
+(
+    gpio_iot_PinRef_t pinRef,
+    gpio_iot_Edge_t trigger,
+    gpio_iot_ChangeCallbackFunc_t handlerPtr,
+    void *contextPtr,
+    int32_t sampleMs
+)
+{
+    gpio_iot_ChangeEventHandlerRef_t handlerRef = GPIO_CALL(pinRef->addChangeEventHandler)(trigger, handlerPtr, contextPtr, sampleMs);
 
-        gpio_iot_GetPullUpDown(gpioNumber);
+    if (handlerRef)
+    {
+        pinRef->edge = trigger;
+        pinRef->shadowFlags |= SHADOW_EDGE;
     }
+
+    return handlerRef;
 }
 
 //Call the proper le_gpioPinxx_AddChangeEventHandler function based on the provided IoT0-GPIO pin# (1 - 4)
@@ -409,81 +683,158 @@ gpio_iot_ChangeEventHandlerRef_t  gpio_iot_AddChangeEventHandler
     int32_t sampleMs
 )
 {
-    const char* name = "AddChangeEventHandler";
-    gpio_le_function_t* gpioFunctionPtr = GetFunctionPtr(name, gpioNumber);
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
+
+    return pinRef ? gpio_iot_PinAddChangeEventHandler(pinRef, trigger, handlerPtr, contextPtr, sampleMs) : NULL;
+}
+
+//Edge of a debounced input : only restart the settle timer, no call to gpioService
+static void OnDebouncedEdge(bool state, void *contextPtr)
+{
+    gpio_iot_Debounce_t* debouncePtr = (gpio_iot_Debounce_t*)contextPtr;
+
+    debouncePtr->bEdgeLevel = state;
+    le_timer_Restart(debouncePtr->settleTimerRef);
+}
+
+//The input has been stable for the settle time : deliver its level if it changed, and if it is a transition of the trigger
+static void OnDebounceSettled(le_timer_Ref_t timerRef)
+{
+    gpio_iot_Debounce_t* debouncePtr = (gpio_iot_Debounce_t*)le_timer_GetContextPtr(timerRef);
+    bool bLevel = debouncePtr->bEdgeLevel;
+
+    if (bLevel == debouncePtr->bStableLevel)
+    {
+        //the contact bounced back to where it was
+        return;
+    }
 
-    if (gpioFunctionPtr)
+    debouncePtr->bStableLevel = bLevel;
+
+    if ((GPIO_IOT_EDGE_BOTH == debouncePtr->trigger) ||
+        ((GPIO_IOT_EDGE_RISING == debouncePtr->trigger) && bLevel) ||
+        ((GPIO_IOT_EDGE_FALLING == debouncePtr->trigger) && !bLevel))
     {
-        pfnIntCbCtxtIntRetChangeEventhRef    pFn = (pfnIntCbCtxtIntRetChangeEventhRef) gpioFunctionPtr->leGpioPtr;
+        debouncePtr->handlerPtr(bLevel, debouncePtr->contextPtr);
+    }
+}
+
+//Set a debounced change handler through the handle of the pin : every edge is taken as an interrupt (sampleMs = 0),
+//the handler is called once per real transition matching the trigger, when the input has been stable for settleMs
+gpio_iot_ChangeEventHandlerRef_t  gpio_iot_PinAddDebouncedChangeEventHandler
+(
+    gpio_iot_PinRef_t pinRef,
+    gpio_iot_Edge_t trigger,
+    gpio_iot_ChangeCallbackFunc_t handlerPtr,
+    void *contextPtr,
+    uint32_t settleMs
+)
+{
+    gpio_iot_Debounce_t* debouncePtr = &_gpio_debounces[pinRef->slot][pinRef->gpioNumber-1];
 
-        return pFn(trigger, handlerPtr, contextPtr, sampleMs);
+    if (NULL == debouncePtr->settleTimerRef)
+    {
+        debouncePtr->settleTimerRef = le_timer_Create("gpioDebounce");
+        le_timer_SetHandler(debouncePtr->settleTimerRef, OnDebounceSettled);
+        le_timer_SetContextPtr(debouncePtr->settleTimerRef, debouncePtr);
     }
 
-    return NULL;
+    le_timer_SetMsInterval(debouncePtr->settleTimerRef, settleMs);
+
+    debouncePtr->trigger = trigger;
+    debouncePtr->handlerPtr = handlerPtr;
+    debouncePtr->contextPtr = contextPtr;
+    debouncePtr->bStableLevel = GPIO_CALL(pinRef->read)();
+    debouncePtr->bEdgeLevel = debouncePtr->bStableLevel;
+
+    //both edges are needed to know where the contact settles
+    return gpio_iot_PinAddChangeEventHandler(pinRef, GPIO_IOT_EDGE_BOTH, OnDebouncedEdge, debouncePtr, 0);
 }
 
-//Call the proper le_gpioPinxx_EnablePullUp function based on the provided IoT0-GPIO pin# (1 - 4)
-le_result_t     gpio_iot_EnablePullUp(uint32_t gpioNumber)
+//Set a debounced change handler on the provided IoT0-GPIO pin# (1 - 4)
+gpio_iot_ChangeEventHandlerRef_t  gpio_iot_AddDebouncedChangeEventHandler
+(
+    uint32_t    gpioNumber,
+    gpio_iot_Edge_t trigger,
+    gpio_iot_ChangeCallbackFunc_t handlerPtr,
+    void *contextPtr,
+    uint32_t settleMs
+)
 {
-    const char* name = "EnablePullUp";
-    gpio_le_function_t* gpioFunctionPtr = GetFunctionPtr(name, gpioNumber);
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
+
+    return pinRef ? gpio_iot_PinAddDebouncedChangeEventHandler(pinRef, trigger, handlerPtr, contextPtr, settleMs) : NULL;
+}
 
-    if (gpioFunctionPtr)
+//Enable the pull up of an input through its handle : direct call to le_gpioPinxx_EnablePullUp
+le_result_t     gpio_iot_PinEnablePullUp(gpio_iot_PinRef_t pinRef)
+{
+    if ((pinRef->shadowFlags & SHADOW_PULL) && (GPIO_IOT_PULL_UP == pinRef->pull))
     {
-        pfnNoArgRetleresult    pFn = (pfnNoArgRetleresult) gpioFunctionPtr->leGpioPtr;
+        return LE_OK;
+    }
 
-        return pFn();
+    le_result_t result = GPIO_CALL(pinRef->enablePullUp)();
 
+    if (LE_OK == result)
+    {
+        pinRef->pull = GPIO_IOT_PULL_UP;
+        pinRef->shadowFlags |= SHADOW_PULL;
     }
 
-    return LE_FAULT;
+    return result;
 }
 
-//Call the proper le_gpioPinxx_EnablePullDown function based on the provided IoT0-GPIO pin# (1 - 4)
-le_result_t     gpio_iot_EnablePullDown(uint32_t gpioNumber)
+//Call the proper le_gpioPinxx_EnablePullUp function based on the provided IoT0-GPIO pin# (1 - 4)
+le_result_t     gpio_iot_EnablePullUp(uint32_t gpioNumber)
 {
-    const char* name = "EnablePullDown";
-    gpio_le_function_t* gpioFunctionPtr = GetFunctionPtr(name, gpioNumber);
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
 
-    if (gpioFunctionPtr)
+    return pinRef ? gpio_iot_PinEnablePullUp(pinRef) : LE_FAULT;
+}
+
+//Enable the pull down of an input through its handle : direct call to le_gpioPinxx_EnablePullDown
+le_result_t     gpio_iot_PinEnablePullDown(gpio_iot_PinRef_t pinRef)
+{
+    if ((pinRef->shadowFlags & SHADOW_PULL) && (GPIO_IOT_PULL_DOWN == pinRef->pull))
     {
-        pfnNoArgRetleresult    pFn = (pfnNoArgRetleresult) gpioFunctionPtr->leGpioPtr;
+        return LE_OK;
+    }
 
-        return pFn();
+    le_result_t result = GPIO_CALL(pinRef->enablePullDown)();
 
+    if (LE_OK == result)
+    {
+        pinRef->pull = GPIO_IOT_PULL_DOWN;
+        pinRef->shadowFlags |= SHADOW_PULL;
     }
 
-    return LE_FAULT;
+    return result;
+}
+
+//Call the proper le_gpioPinxx_EnablePullDown function based on the provided IoT0-GPIO pin# (1 - 4)
+le_result_t     gpio_iot_EnablePullDown(uint32_t gpioNumber)
+{
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
+
+    return pinRef ? gpio_iot_PinEnablePullDown(pinRef) : LE_FAULT;
 }
     
 //Call the proper le_gpioPinxx_GetEdgeSense function based on the provided IoT0-GPIO pin# (1 - 4)
 gpio_iot_Edge_t  gpio_iot_gpio1_GetEdgeSense(uint32_t gpioNumber)
 {
-    const char* name = "GetEdgeSense";
-    gpio_le_function_t* gpioFunctionPtr = GetFunctionPtr(name, gpioNumber);
+    gpio_iot_PinRef_t pinRef = gpio_iot_GetPin(gpioNumber);
 
-    if (gpioFunctionPtr)
+    if (pinRef)
     {
-        pfnNoArgRetEdge    pFn = (pfnNoArgRetEdge) gpioFunctionPtr->leGpioPtr;
-
-        gpio_iot_Edge_t    edgeSense = pFn();
-
-        if (GPIO_IOT_EDGE_FALLING == edgeSense)
-        {
-            LE_INFO("%s - GPIO_%d - CF3-Pin%d - %s : %s", _gpio_mangoh_board[_gpio_iot_mangohType], gpioNumber, gpioFunctionPtr->cf3GpioPinNumber, name, "Falling edge");
-        }
-        else if (GPIO_IOT_EDGE_RISING == edgeSense)
-        {
-            LE_INFO("%s - GPIO_%d - CF3-Pin%d - %s : %s", _gpio_mangoh_board[_gpio_iot_mangohType], gpioNumber, gpioFunctionPtr->cf3GpioPinNumber, name, "Rising edge");
-        }
-        else if (GPIO_IOT_EDGE_BOTH == edgeSense)
+        if (!IsShadowed(pinRef, SHADOW_EDGE))
         {
-            LE_INFO("%s - GPIO_%d - CF3-Pin%d - %s : %s", _gpio_mangoh_board[_gpio_iot_mangohType], gpioNumber, gpioFunctionPtr->cf3GpioPinNumber, name, "Both edges");
+            pinRef->edge = GPIO_CALL(pinRef->getEdgeSense)();
+            pinRef->shadowFlags |= SHADOW_EDGE;
         }
-        else if (GPIO_IOT_EDGE_NONE == edgeSense)
-        {
-            LE_INFO("%s - GPIO_%d - CF3-Pin%d - %s : %s", _gpio_mangoh_board[_gpio_iot_mangohType], gpioNumber, gpioFunctionPtr->cf3GpioPinNumber, name, "NO edge");
-        }    
+        gpio_iot_Edge_t    edgeSense = pinRef->edge;
+
+        trace_Add(TRACE_GPIO_EDGE, gpioNumber, pinRef->cf3GpioPinNumber, edgeSense);
 
         return edgeSense;
     }
@@ -496,17 +847,19 @@ void gpio_iot_Init()
 {
     //Specify the type of mangOH board.
     //The same application and the same IOT board can be reused on mangOH Red/Green without changing the code nor wiring.
-    int cfgValue = le_cfg_QuickGetInt(CONFIG_TREE_MANGOH_BOARD_INT, -1);
-    if (cfgValue < 0)
+    if (_gpio_configLoaded)
     {
-        LE_INFO("No setting in Config Tree, default to mangOH Green");
-        gpio_iot_SetMangohType(GPIO_IOT_MANGOH_GREEN);
+        //already read along with the settings of the app
+        return;
     }
-    else
+
+    le_cfg_IteratorRef_t txnRef = le_cfg_CreateReadTxn("/");
+    bool found = gpio_iot_LoadConfig(txnRef);
+    le_cfg_CancelTxn(txnRef);
+
+    if (!found)
     {
-        LE_INFO("mangOH board type in Config Tree is %d", cfgValue);
-        //set the board type in the helper lib
-        gpio_iot_SetMangohType(cfgValue);
+        le_cfg_QuickSetInt(CONFIG_TREE_MANGOH_BOARD_INT, _gpio_iot_mangohType);
     }
 }
 
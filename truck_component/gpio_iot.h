@@ -36,25 +36,56 @@ typedef enum
     GPIO_IOT_PULL_UP = 2
 } gpio_iot_PullUpDown_t;
 
+//IoT slots of the mangOH board (IoT0 - IoT2), the GPIO (1-4) functions without a slot address IoT0
+#define GPIO_IOT_SLOT_COUNT					3
+
+//bit of a GPIO (1-4) in the masks of gpio_iot_SetOutputs / gpio_iot_ReadInputs
+#define GPIO_IOT_MASK(gpioNumber)			(1u << ((gpioNumber) - 1))
+
 typedef void(* 	gpio_iot_ChangeCallbackFunc_t) (bool state, void *contextPtr);
 
 typedef struct gpio_iot_ChangeEventHandler* gpio_iot_ChangeEventHandlerRef_t;
 
+//Handle of an IoT GPIO, its le_gpio functions are resolved for the current mangOH board
+typedef struct gpio_iot_Pin* gpio_iot_PinRef_t;
+
 
 ////////////////////////////////////////////////////////////////
-//Initializer : call this first before accessing other function
+//Initializer : call this first before accessing other function, the board type is read from Config Tree unless gpio_iot_LoadConfig() did it
 void 								gpio_iot_Init();
 
 ////////////////////////////////////////////////////////////////
 //mangOH board Type
 gpio_iot_mangohType_t 				gpio_iot_GetMangohType();
-void 								gpio_iot_SetMangohType(gpio_iot_mangohType_t mangohType);
+void 								gpio_iot_SetMangohType(gpio_iot_mangohType_t mangohType);	//re-resolves the pin handles
+void								gpio_iot_SaveConfig(le_cfg_IteratorRef_t txnRef);			//persists the board type within the caller's write transaction
+bool								gpio_iot_LoadConfig(le_cfg_IteratorRef_t txnRef);			//reads the board type within the caller's read transaction, false if missing (default applied)
+void								gpio_iot_WriteConfig(le_cfg_IteratorRef_t txnRef, gpio_iot_mangohType_t mangohType);	//persists the given board type, for a commit of a snapshot
+
+////////////////////////////////////////////////////////////////
+//Pin handles : resolved at gpio_iot_Init() from the pin map (Config Tree over the board defaults), no lookup when accessing the pin
+gpio_iot_PinRef_t					gpio_iot_GetPin(uint32_t gpioNumber);			//GPIO (1-4) of IoT0, NULL if invalid or not wired
+gpio_iot_PinRef_t					gpio_iot_GetSlotPin(uint32_t slot, uint32_t gpioNumber);	//GPIO (1-4) of IoT slot (0-2), NULL if invalid or not wired
+bool								gpio_iot_PinRead(gpio_iot_PinRef_t pinRef);
+void								gpio_iot_PinSetOutput(gpio_iot_PinRef_t pinRef, bool bActivate);
+
+//Configuration through a pin handle, for the GPIOs of any IoT slot : the GPIO (1-4) functions below route to these for IoT0
+void								gpio_iot_PinSetPushPullOutput(gpio_iot_PinRef_t pinRef, bool bActiveHigh, bool bInitValue);
+void								gpio_iot_PinSetInput(gpio_iot_PinRef_t pinRef, bool bActiveHigh);
+le_result_t							gpio_iot_PinEnablePullUp(gpio_iot_PinRef_t pinRef);
+le_result_t							gpio_iot_PinEnablePullDown(gpio_iot_PinRef_t pinRef);
+gpio_iot_ChangeEventHandlerRef_t	gpio_iot_PinAddChangeEventHandler(gpio_iot_PinRef_t pinRef, gpio_iot_Edge_t trigger,
+																	  gpio_iot_ChangeCallbackFunc_t handlerPtr, void *contextPtr, int32_t sampleMs);
+gpio_iot_ChangeEventHandlerRef_t	gpio_iot_PinAddDebouncedChangeEventHandler(gpio_iot_PinRef_t pinRef, gpio_iot_Edge_t trigger,
+																			   gpio_iot_ChangeCallbackFunc_t handlerPtr, void *contextPtr, uint32_t settleMs);
 
 
 //Configure the specified GPIO (1-4) as Output
 void                    			gpio_iot_SetPushPullOutput(uint32_t gpioNumber, bool bActiveHigh, bool bInitValue);
 //Set the output level
 void                    			gpio_iot_SetOutput(uint32_t gpioNumber, bool bActivate);
+//Set the level of several outputs in one pass (GPIO_IOT_MASK bits), outputs already at their level are skipped
+le_result_t							gpio_iot_SetOutputs(uint32_t mask, uint32_t values);
 
 
 //Configure the specified GPIO (1-4) as Input
@@ -70,15 +101,30 @@ gpio_iot_ChangeEventHandlerRef_t  	gpio_iot_AddChangeEventHandler
                                             void *contextPtr,
                                             int32_t sampleMs
                                         );
+//Set a debounced GPIO input change handler : edge interrupts only, called once per transition stable for settleMs
+gpio_iot_ChangeEventHandlerRef_t  	gpio_iot_AddDebouncedChangeEventHandler
+                                        (
+                                        	uint32_t gpioNumber,
+                                            gpio_iot_Edge_t trigger,
+                                            gpio_iot_ChangeCallbackFunc_t handlerPtr,
+                                            void *contextPtr,
+                                            uint32_t settleMs
+                                        );
 
-//Read the output of the specified GPIO (1-4)
+//Read the output of the specified GPIO (1-4), an output answers the level last driven by the app
 bool                    			gpio_iot_Read(uint32_t gpioNumber);				//true=activated, false=deactivated
+//Read several GPIOs at once (GPIO_IOT_MASK bits), levels are returned in the matching bits
+uint32_t							gpio_iot_ReadInputs(uint32_t mask);
 
-//Properties of the specified GPIO (1-4)
+//Properties of the specified GPIO (1-4), answered from the state last configured by the app
 bool                    			gpio_iot_IsInput(uint32_t gpioNumber);			//true=Input, false=OUTPUT
 gpio_iot_Edge_t        				gpio_iot_GetEdgeSense(uint32_t gpioNumber);     //0=NONE, 1=RISING, 2=FALLING, 3=BOTH
 bool                    			gpio_iot_GetPolarity(uint32_t gpioNumber);		//true= ACTIVE_HIGH, false=ACTIVE_LOW
 gpio_iot_PullUpDown_t               gpio_iot_GetPullUpDown(uint32_t gpioNumber);	//0=GPIO_IOT_PULL_OFF, 1=GPIO_IOT_PULL_DOWN, 2=GPIO_IOT_PULL_UP
 
+//Diagnostics : read back from gpioService instead of the cached state, and verify every change
+void								gpio_iot_SetVerifyMode(bool bVerify);
+uint32_t							gpio_iot_GetCallCount();						//calls sent to gpioService since start
+
 
 #endif 	//_GPIO_IOT_H_
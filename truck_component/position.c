@@ -4,7 +4,12 @@
  *
  * Helper lib wrapping le_pos, le_posCtrl and le_avdata, to simplify the 2 following key features:
  *      Get the current location coordinates (longitude, latitude, altitude, accuracies)
- *      Push the current location to AirVantage
+ *      Push the current location to AirVantage, on its own or along with a timeserie
+ *
+ *  The last fix is kept up to date by a le_pos movement handler : it is only refreshed when the truck moved
+ *  more than the movement thresholds, and reading it costs no IPC.
+ *  In duty-cycled mode (position_SetFixInterval), positioning is only activated for a fix every interval,
+ *  and released as soon as the fix is got or after a timeout. The location is then polled on the worker thread.
  *
  *  NC - March 2018
  */
@@ -15,6 +20,11 @@
 #include "interfaces.h"
 
 #include "position.h"
+#include "record.h"
+#include "session.h"
+#include "scheduler.h"
+#include "worker.h"
+#include "trace.h"
 
 //data path for location objects
 #define GPS_LAT                             "lwm2m.6.0.0"
@@ -22,9 +32,49 @@
 #define GPS_ALTITUDE                        "lwm2m.6.0.2"
 #define GPS_RADIUS                          "lwm2m.6.0.3"
 
+//default movement thresholds (meters)
+#define POSITION_DEFAULT_H_MAGNITUDE		50
+#define POSITION_DEFAULT_V_MAGNITUDE		50
+
+//duty-cycled mode : the fix state is polled while positioning is active, for at most the timeout
+#define POSITION_FIX_POLL_MS				5000
+#define POSITION_FIX_TIMEOUT_SEC			120
+
 //Global variables
 static le_posCtrl_ActivationRef_t   		_posCtrlRef = NULL;
-static le_avdata_RequestSessionObjRef_t		_requestSessionRef = NULL;
+static bool									_locationPending = false;			//a location push was held while the session was down
+static le_pos_MovementHandlerRef_t			_movementHandlerRef = NULL;
+static uint32_t								_hMagnitude = POSITION_DEFAULT_H_MAGNITUDE;
+static uint32_t								_vMagnitude = POSITION_DEFAULT_V_MAGNITUDE;
+static uint32_t								_fixInterval = 0;					//seconds between 2 fixes in duty-cycled mode, 0 : always active
+static scheduler_JobRef_t					_fixJobRef = NULL;
+static le_timer_Ref_t						_fixPollTimerRef = NULL;
+static time_t								_fixStartTime = 0;					//relative time the positioning was activated for a fix (seconds)
+
+//last fix received from the movement handler
+static struct
+{
+	position_location_type_t	type;
+	double						dLatitude;
+	double						dLongitude;
+	int32_t						hAccuracy;
+	int32_t						altitude;
+	int32_t						vAccuracy;
+	time_t						time;				//relative time of the fix (seconds)
+} _lastFix = { .type = POSITION_LOCATION_NO };
+
+//location read by the worker thread for the duty-cycled mode, one read at a time
+static struct
+{
+	bool						pending;
+	position_location_type_t	type;
+	le_pos_FixState_t			fixState;
+	double						dLatitude;
+	double						dLongitude;
+	int32_t						hAccuracy;
+	int32_t						altitude;
+	int32_t						vAccuracy;
+} _fixRead;
 
 //Callback function to handler AirVantage publishing status
 void position_PushRecordCallbackHandler
@@ -33,36 +83,44 @@ void position_PushRecordCallbackHandler
     void* contextPtr
 )
 {
-    if (status == LE_AVDATA_PUSH_SUCCESS)
- 	{
- 		LE_INFO("Push Location OK");
- 	}
- 	else
+    trace_Add(TRACE_LOCATION_ACK, status, 0, 0);
+
+    if (status != LE_AVDATA_PUSH_SUCCESS)
  	{
- 		LE_INFO("Failed to push Location");
+ 		LE_WARN("Failed to push Location");
  	}
+
+ 	session_PushCompleted((uint32_t)(uintptr_t)contextPtr, status == LE_AVDATA_PUSH_SUCCESS);
 }
 
-//Helper, request a connection to AirVantage if not done yet
-le_avdata_RequestSessionObjRef_t position_CheckConnection()
+//Helper, true if a push can be issued, otherwise the push is held until the session is back or no longer stalled
+static bool CheckConnection()
 {
-	if (!_requestSessionRef)
+	if (!session_CanPush())
 	{
-		_requestSessionRef = le_avdata_RequestSession();
+		_locationPending = true;
+		return false;
 	}
 
-	return _requestSessionRef;
+	_locationPending = false;
+
+	return true;
 }
 
 //Helper function to perform a 3D fix and push location to AirVantage
 le_result_t position_Push3DLocation(double dLatitude, double dLongitude, double dRadius, double dAltitude, double dvRadius)
 {
-	if (NULL == position_CheckConnection())
+	if (!CheckConnection())
 	{
-		return LE_FAULT;
+		return LE_UNAVAILABLE;
 	}
 
-	le_avdata_RecordRef_t recordRef = le_avdata_CreateRecord();
+	le_avdata_RecordRef_t recordRef = record_Acquire();
+
+	if (NULL == recordRef)
+	{
+		return LE_NO_MEMORY;
+	}
 
 	uint64_t        utcMilliSec;
 	struct timeval  tv;
@@ -75,18 +133,21 @@ le_result_t position_Push3DLocation(double dLatitude, double dLongitude, double
 	le_avdata_RecordFloat(recordRef, GPS_RADIUS, dRadius, utcMilliSec);
 	le_avdata_RecordFloat(recordRef, GPS_ALTITUDE, dAltitude, utcMilliSec);
 
-	le_result_t res = le_avdata_PushRecord(recordRef, position_PushRecordCallbackHandler, NULL);
+	le_result_t res = le_avdata_PushRecord(recordRef, position_PushRecordCallbackHandler, (void*)(uintptr_t)session_GetEpoch());
+
+	trace_Add(TRACE_LOCATION_PUSH, res, (int32_t)dRadius, 0);
 
 	if (LE_FAULT == res)
 	{
-		LE_INFO("Failed pushing GNSS");
+		LE_WARN("Failed pushing GNSS");
 	}
-	else if (LE_OK == res)
+
+	if (LE_OK == res)
 	{
-		LE_INFO("GNSS location pushed OK");
+		session_PushIssued();
 	}
 
-	le_avdata_DeleteRecord(recordRef);
+	record_Release(recordRef, false);
 
 	return res;
 }
@@ -94,12 +155,17 @@ le_result_t position_Push3DLocation(double dLatitude, double dLongitude, double
 //Helper function to perform a 2D fix and push location to AirVantage
 le_result_t position_Push2DLocation(double dLatitude, double dLongitude, double dRadius)
 {
-	if (NULL == position_CheckConnection())
+	if (!CheckConnection())
 	{
-		return LE_FAULT;
+		return LE_UNAVAILABLE;
 	}
 	
-	le_avdata_RecordRef_t recordRef = le_avdata_CreateRecord();
+	le_avdata_RecordRef_t recordRef = record_Acquire();
+
+	if (NULL == recordRef)
+	{
+		return LE_NO_MEMORY;
+	}
 
 	uint64_t        utcMilliSec;
 	struct timeval  tv;
@@ -111,18 +177,21 @@ le_result_t position_Push2DLocation(double dLatitude, double dLongitude, double
 	le_avdata_RecordFloat(recordRef, GPS_LONG, dLongitude, utcMilliSec);
 	le_avdata_RecordFloat(recordRef, GPS_RADIUS, dRadius, utcMilliSec);
 
-	le_result_t res = le_avdata_PushRecord(recordRef, position_PushRecordCallbackHandler, NULL);
+	le_result_t res = le_avdata_PushRecord(recordRef, position_PushRecordCallbackHandler, (void*)(uintptr_t)session_GetEpoch());
+
+	trace_Add(TRACE_LOCATION_PUSH, res, (int32_t)dRadius, 0);
 
 	if (LE_FAULT == res)
 	{
-		LE_INFO("Failed pushing GNSS");
+		LE_WARN("Failed pushing GNSS");
 	}
-	else if (LE_OK == res)
+
+	if (LE_OK == res)
 	{
-		LE_INFO("GNSS location pushed OK");
+		session_PushIssued();
 	}
 
-	le_avdata_DeleteRecord(recordRef);
+	record_Release(recordRef, false);
 
 	return res;
 }
@@ -146,16 +215,10 @@ position_location_type_t position_GetLocation
 
 	if (LE_OK == le_pos_GetFixState(&fixState))
 	{
-		LE_INFO("position fix state %d", fixState);
-
 		if (LE_POS_STATE_FIX_3D == fixState)
 		{
 			res = le_pos_Get3DLocation(&latitude, &longitude, hAccuracy, altitude, vAccuracy);
 
-			LE_INFO("le_pos_Get3DLocation %s",
-					(LE_OK == res) ? "OK" : (LE_OUT_OF_RANGE == res) ? "parameter(s) out of range":"ERROR");
-			LE_INFO("Get3DLocation latitude.%d, longitude.%d, hAccuracy.%d, altitude.%d, vAccuracy.%d", latitude, longitude, *hAccuracy, *altitude, *vAccuracy);
-
 			if (LE_OK == res)
 			{
 				*dLatitude = (double)latitude/1000000.0;
@@ -167,11 +230,6 @@ position_location_type_t position_GetLocation
 		{
 			res = le_pos_Get2DLocation(&latitude, &longitude, hAccuracy);
 
-			LE_INFO("le_pos_Get2DLocation %s",
-					(LE_OK == res) ? "OK" : (LE_OUT_OF_RANGE == res) ? "parameter(s) out of range":"ERROR");
-			LE_INFO("Get2DLocation latitude.%d, longitude.%d, hAccuracy.%d",
-					latitude, longitude, *hAccuracy);
-
 			if (LE_OK == res)
 			{
 				*dLatitude = (double)latitude/1000000.0;
@@ -180,11 +238,14 @@ position_location_type_t position_GetLocation
 				*vAccuracy = 0;
 				ret = POSITION_LOCATION_2D;
 			}
-		}            
+		}
+
+		//no location yet is not an error : out of range until the first fix
+		trace_Add(TRACE_LOCATION_READ, fixState, (LE_OK == res) ? latitude : 0, (LE_OK == res) ? longitude : 0);
 	}
 	else
 	{
-		LE_INFO("Failed to GetFixState");
+		LE_WARN("Failed to GetFixState");
 	}
 
 	if (fixStatePtr)
@@ -195,6 +256,97 @@ position_location_type_t position_GetLocation
 	return ret;
 }
 
+//return the last fix reported by the movement handler, without any IPC
+position_location_type_t position_GetLastLocation
+(
+	double*     			dLatitude,
+	double*     			dLongitude,
+	int32_t*    			hAccuracy,
+	int32_t*    			altitude,
+	int32_t*    			vAccuracy,
+	uint32_t*				ageSecPtr
+)
+{
+	if (POSITION_LOCATION_NO != _lastFix.type)
+	{
+		*dLatitude = _lastFix.dLatitude;
+		*dLongitude = _lastFix.dLongitude;
+		*hAccuracy = _lastFix.hAccuracy;
+		*altitude = _lastFix.altitude;
+		*vAccuracy = _lastFix.vAccuracy;
+
+		if (ageSecPtr)
+		{
+			*ageSecPtr = le_clk_GetRelativeTime().sec - _lastFix.time;
+		}
+	}
+
+	return _lastFix.type;
+}
+
+//Movement handler : the truck moved more than the thresholds, refresh the last fix
+static void OnMovement
+(
+	le_pos_SampleRef_t	positionSampleRef,
+	void*				contextPtr
+)
+{
+	le_pos_FixState_t	fixState = LE_POS_STATE_UNKNOWN;
+	int32_t				latitude;
+	int32_t				longitude;
+	int32_t				hAccuracy;
+	int32_t				altitude = 0;
+	int32_t				vAccuracy = 0;
+
+	if ((LE_OK == le_pos_sample_GetFixState(positionSampleRef, &fixState)) &&
+		((LE_POS_STATE_FIX_2D == fixState) || (LE_POS_STATE_FIX_3D == fixState)) &&
+		(LE_OK == le_pos_sample_Get2DLocation(positionSampleRef, &latitude, &longitude, &hAccuracy)))
+	{
+		_lastFix.type = POSITION_LOCATION_2D;
+
+		if ((LE_POS_STATE_FIX_3D == fixState) &&
+			(LE_OK == le_pos_sample_GetAltitude(positionSampleRef, &altitude, &vAccuracy)))
+		{
+			_lastFix.type = POSITION_LOCATION_3D;
+		}
+
+		_lastFix.dLatitude = (double)latitude/1000000.0;
+		_lastFix.dLongitude = (double)longitude/1000000.0;
+		_lastFix.hAccuracy = hAccuracy;
+		_lastFix.altitude = altitude;
+		_lastFix.vAccuracy = vAccuracy;
+		_lastFix.time = le_clk_GetRelativeTime().sec;
+	}
+
+	le_pos_sample_Release(positionSampleRef);
+}
+
+//register the movement handler with the current thresholds
+static void AddMovementHandler()
+{
+	if (_movementHandlerRef)
+	{
+		le_pos_RemoveMovementHandler(_movementHandlerRef);
+	}
+
+	_movementHandlerRef = le_pos_AddMovementHandler(_hMagnitude, _vMagnitude, OnMovement, NULL);
+}
+
+//set the distances (meters) the truck has to move before the last fix is refreshed
+void position_SetMovementThresholds(uint32_t hMagnitude, uint32_t vMagnitude)
+{
+	if ((hMagnitude != _hMagnitude) || (vMagnitude != _vMagnitude))
+	{
+		_hMagnitude = hMagnitude;
+		_vMagnitude = vMagnitude;
+
+		if (_movementHandlerRef)
+		{
+			AddMovementHandler();
+		}
+	}
+}
+
 //a simple helper function to perform on-demand fix and post locatin to AirVantage
 le_result_t position_PushLocation(le_pos_FixState_t * 	fixStatePtr)
 {
@@ -220,27 +372,212 @@ le_result_t position_PushLocation(le_pos_FixState_t * 	fixStatePtr)
 	return res;
 }
 
-//release positioning service and release session with AirVantage
-void position_Stop()
+//Append the current location to a timeserie record, with the timestamp of the other samples of the record
+//This saves a separate push : the location goes along with the sensor data
+le_result_t position_AppendToRecord(le_avdata_RecordRef_t recordRef, uint64_t utcMilliSec)
+{
+	double	latitude;
+	double	longitude;
+	int32_t	hAccuracy;
+	int32_t	altitude;
+	int32_t	vAccuracy;
+
+	position_location_type_t ret = position_GetLastLocation(&latitude, &longitude, &hAccuracy, &altitude, &vAccuracy, NULL);
+
+	if (POSITION_LOCATION_NO == ret)
+	{
+		return LE_UNAVAILABLE;
+	}
+
+	le_result_t res = le_avdata_RecordFloat(recordRef, GPS_LAT, latitude, utcMilliSec);
+
+	if (LE_OK == res)
+	{
+		res = le_avdata_RecordFloat(recordRef, GPS_LONG, longitude, utcMilliSec);
+	}
+
+	if (LE_OK == res)
+	{
+		res = le_avdata_RecordFloat(recordRef, GPS_RADIUS, hAccuracy, utcMilliSec);
+	}
+
+	if ((LE_OK == res) && (POSITION_LOCATION_3D == ret))
+	{
+		res = le_avdata_RecordFloat(recordRef, GPS_ALTITUDE, altitude, utcMilliSec);
+	}
+
+	return res;
+}
+
+//Flush handler, the session is back : push the last fix if a location push was held meanwhile
+static void OnSessionFlush(void* contextPtr)
+{
+	if (!_locationPending)
+	{
+		return;
+	}
+
+	if (POSITION_LOCATION_3D == _lastFix.type)
+	{
+		position_Push3DLocation(_lastFix.dLatitude, _lastFix.dLongitude, _lastFix.hAccuracy, _lastFix.altitude, _lastFix.vAccuracy);
+	}
+	else if (POSITION_LOCATION_2D == _lastFix.type)
+	{
+		position_Push2DLocation(_lastFix.dLatitude, _lastFix.dLongitude, _lastFix.hAccuracy);
+	}
+}
+
+//activate positioning, the GNSS receiver is powered
+static void RequestPositioning()
+{
+	if (NULL == _posCtrlRef)
+	{
+		_posCtrlRef = le_posCtrl_Request();
+		if (NULL == _posCtrlRef)
+		{
+			LE_INFO("Cannot activate le_pos !");
+		}
+	}
+}
+
+//release positioning, the GNSS receiver can be powered down
+static void ReleasePositioning()
 {
 	if (NULL != _posCtrlRef)
 	{
 		le_posCtrl_Release(_posCtrlRef);
+		_posCtrlRef = NULL;
+	}
+}
+
+//Worker job of the duty-cycled mode : read the location, the le_pos calls wait for the positioning service
+static void ReadFix(void* contextPtr)
+{
+	_fixRead.fixState = LE_POS_STATE_UNKNOWN;
+	_fixRead.type = position_GetLocation(&_fixRead.dLatitude, &_fixRead.dLongitude, &_fixRead.hAccuracy,
+										 &_fixRead.altitude, &_fixRead.vAccuracy, &_fixRead.fixState);
+}
+
+//Location read, back on the main thread : keep the fix as the last one and release positioning, or give up after the timeout
+static void OnFixRead(void* contextPtr)
+{
+	_fixRead.pending = false;
+
+	if ((0 == _fixInterval) || (NULL == _posCtrlRef))
+	{
+		//always active or stopped meanwhile, nothing to release
+		return;
+	}
+
+	if ((POSITION_LOCATION_NO != _fixRead.type) && ((LE_POS_STATE_FIX_2D == _fixRead.fixState) || (LE_POS_STATE_FIX_3D == _fixRead.fixState)))
+	{
+		_lastFix.type = _fixRead.type;
+		_lastFix.dLatitude = _fixRead.dLatitude;
+		_lastFix.dLongitude = _fixRead.dLongitude;
+		_lastFix.hAccuracy = _fixRead.hAccuracy;
+		_lastFix.altitude = _fixRead.altitude;
+		_lastFix.vAccuracy = _fixRead.vAccuracy;
+		_lastFix.time = le_clk_GetRelativeTime().sec;
+
+		LE_INFO("Fix got after %ld seconds, releasing positioning", (long)(_lastFix.time - _fixStartTime));
+		ReleasePositioning();
+	}
+	else if ((le_clk_GetRelativeTime().sec - _fixStartTime) >= POSITION_FIX_TIMEOUT_SEC)
+	{
+		LE_INFO("No fix after %d seconds, releasing positioning", POSITION_FIX_TIMEOUT_SEC);
+		ReleasePositioning();
+	}
+	else
+	{
+		le_timer_Start(_fixPollTimerRef);
 	}
+}
 
-	if (_requestSessionRef)
+//Poll timer of the duty-cycled mode : the location is read by the worker thread
+static void OnFixPollTimer(le_timer_Ref_t timerRef)
+{
+	_fixRead.pending = true;
+	worker_Submit(ReadFix, OnFixRead, NULL);
+}
+
+//Fix job of the duty-cycled mode : activate positioning until a fix is got
+static void StartFix(void* contextPtr)
+{
+	if (le_timer_IsRunning(_fixPollTimerRef) || _fixRead.pending)
 	{
-		le_avdata_ReleaseSession(_requestSessionRef);
+		return;
 	}
+
+	RequestPositioning();
+	_fixStartTime = le_clk_GetRelativeTime().sec;
+	le_timer_Start(_fixPollTimerRef);
 }
 
-//Initialize the positioning service
-void position_Start()
+//set the interval (seconds) between 2 fixes : positioning is only active for a fix every interval. 0 : always active
+void position_SetFixInterval(uint32_t intervalSec)
 {
-	_posCtrlRef = le_posCtrl_Request();
-	if (NULL == _posCtrlRef)
+	if (intervalSec == _fixInterval)
+	{
+		return;
+	}
+
+	_fixInterval = intervalSec;
+
+	if (NULL == _fixPollTimerRef)
 	{
-		LE_INFO("Cannot activate le_pos !");
+		_fixPollTimerRef = le_timer_Create("positionFixTimer");
+		le_timer_SetMsInterval(_fixPollTimerRef, POSITION_FIX_POLL_MS);
+		le_timer_SetHandler(_fixPollTimerRef, OnFixPollTimer);
+		_fixJobRef = scheduler_AddJob("fix", 0, StartFix, NULL);
 	}
+
+	scheduler_SetJobPeriod(_fixJobRef, _fixInterval);
+
+	if (0 == _fixInterval)
+	{
+		le_timer_Stop(_fixPollTimerRef);
+		RequestPositioning();
+	}
+	else if (POSITION_LOCATION_NO == _lastFix.type)
+	{
+		//no fix yet, take one right away
+		StartFix(NULL);
+	}
+	else if (!le_timer_IsRunning(_fixPollTimerRef) && !_fixRead.pending)
+	{
+		//the next fix is taken by the job
+		ReleasePositioning();
+	}
+
+	LE_INFO("Positioning %s", _fixInterval ? "duty-cycled" : "always active");
+}
+
+//release positioning service
+void position_Stop()
+{
+	if (_movementHandlerRef)
+	{
+		le_pos_RemoveMovementHandler(_movementHandlerRef);
+		_movementHandlerRef = NULL;
+	}
+
+	if (_fixPollTimerRef)
+	{
+		le_timer_Stop(_fixPollTimerRef);
+	}
+
+	ReleasePositioning();
+}
+
+//Initialize the positioning service, always active until position_SetFixInterval() says otherwise
+void position_Start()
+{
+	RequestPositioning();
+
+	//the first fix is reported as a movement, then each time the truck moved beyond the thresholds
+	AddMovementHandler();
+
+	//the AirVantage session is shared with the app, held location pushes are flushed when it is back
+	session_AddFlushHandler(OnSessionFlush, NULL);
 }
 
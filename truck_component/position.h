@@ -4,7 +4,7 @@
  *
  * Helper lib wrapping le_pos, le_posCtrl and le_avdata, to simplify the 2 following key features:
  *      Get the current location coordinates (longitude, latitude, altitude, accuracies)
- *      Push the current location to AirVantage
+ *      Push the current location to AirVantage, on its own or along with a timeserie
  *
  *  NC - March 2018
  */
@@ -30,6 +30,10 @@ void position_Stop();
 //Call this function to push the current position to AirVantage.
 le_result_t position_PushLocation(le_pos_FixState_t *		fixStatePtr);
 
+//Call this function to add the last fix to a timeserie record, pushed along with the other data of the record
+//LE_UNAVAILABLE if there is no fix
+le_result_t position_AppendToRecord(le_avdata_RecordRef_t recordRef, uint64_t utcMilliSec);
+
 //To retrive the position, the return informs the type of positioning being retrieved (2D, 3D or failure)
 position_location_type_t position_GetLocation
 								(
@@ -41,6 +45,23 @@ position_location_type_t position_GetLocation
 									le_pos_FixState_t * 	fixStatePtr
 								);
 
+//To retrieve the last fix reported by the movement handler, without any IPC. ageSecPtr (optional) receives the age of the fix
+position_location_type_t position_GetLastLocation
+								(
+									double*     			dLatitude,
+									double*     			dLongitude,
+									int32_t*    			hAccuracy,
+									int32_t*    			altitude,
+									int32_t*    			vAccuracy,
+									uint32_t*				ageSecPtr
+								);
+
+//Interval (seconds) between 2 fixes : positioning is only activated for a fix every interval, and released once it is got. 0 : always active (default)
+void position_SetFixInterval(uint32_t intervalSec);
+
+//Distances (meters) the truck has to move horizontally/vertically before the last fix is refreshed
+void position_SetMovementThresholds(uint32_t hMagnitude, uint32_t vMagnitude);
+
 //Push the specified 3D position to AirVantage
 le_result_t position_Push2DLocation(double dLatitude, double dLongitude, double dRadius);
 
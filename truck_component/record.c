@@ -0,0 +1,86 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file record.c
+ *
+ * Helper lib managing the lifecycle of le_avdata timeserie records, shared by the app and the helper libs:
+ *      A record given back empty is reused instead of being deleted and created again, a pushed one is deleted
+ *      The number of live records in avcService is capped, so memory use stays bounded on long runs
+ *
+ *  le_avdata gives no way to clear a record, nor to check that avcService cleared a pushed one :
+ *  only a record in which nothing has been recorded is known to be empty, and kept for reuse.
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "record.h"
+
+//max number of records alive in avcService
+#define RECORD_MAX_LIVE				4
+
+//max number of empty records kept for reuse
+#define RECORD_MAX_FREE				2
+
+static le_avdata_RecordRef_t		_recordFree[RECORD_MAX_FREE];
+static size_t						_recordFreeCount = 0;
+static size_t						_recordOutstanding = 0;
+
+
+//get an empty record : reuse one given back empty if any, otherwise create one within the cap
+le_avdata_RecordRef_t record_Acquire()
+{
+	le_avdata_RecordRef_t recordRef = NULL;
+
+	if (_recordFreeCount)
+	{
+		recordRef = _recordFree[--_recordFreeCount];
+	}
+	else if (record_GetLive() < RECORD_MAX_LIVE)
+	{
+		recordRef = le_avdata_CreateRecord();
+	}
+	else
+	{
+		LE_WARN("Max number of records reached (%d)", RECORD_MAX_LIVE);
+	}
+
+	if (recordRef)
+	{
+		_recordOutstanding++;
+	}
+
+	return recordRef;
+}
+
+//give a record back : kept for reuse if nothing has been recorded in it, deleted otherwise
+void record_Release(le_avdata_RecordRef_t recordRef, bool bEmpty)
+{
+	if (NULL == recordRef)
+	{
+		return;
+	}
+
+	_recordOutstanding--;
+
+	if (bEmpty && (_recordFreeCount < RECORD_MAX_FREE))
+	{
+		_recordFree[_recordFreeCount++] = recordRef;
+	}
+	else
+	{
+		le_avdata_DeleteRecord(recordRef);
+	}
+}
+
+//number of records in use
+size_t record_GetOutstanding()
+{
+	return _recordOutstanding;
+}
+
+//number of records alive in avcService
+size_t record_GetLive()
+{
+	return _recordOutstanding + _recordFreeCount;
+}
@@ -0,0 +1,27 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file record.h
+ *
+ * Helper lib managing the lifecycle of le_avdata timeserie records, shared by the app and the helper libs:
+ *      A record given back empty is reused instead of being deleted and created again, a pushed one is deleted
+ *      The number of live records in avcService is capped, so memory use stays bounded on long runs
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _RECORD_H_
+#define _RECORD_H_
+
+//Get an empty record, NULL if the cap of live records is reached
+le_avdata_RecordRef_t record_Acquire();
+
+//Give a record back : bEmpty if nothing has been recorded in it since it was acquired, it is then kept for reuse
+//a record pushed or holding data is deleted
+void record_Release(le_avdata_RecordRef_t recordRef, bool bEmpty);
+
+//Number of records acquired and not released yet
+size_t record_GetOutstanding();
+
+//Number of records alive in avcService (outstanding + kept for reuse)
+size_t record_GetLive();
+
+#endif //_RECORD_H_
@@ -0,0 +1,140 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file scheduler.c
+ *
+ * Helper lib running all the periodic jobs of the app from a single timer:
+ *      Job periods are aligned on a common time origin, jobs falling due together run in the same wakeup
+ *      Changing the period of a job keeps it aligned, there is no phase drift
+ *
+ *  A job of period P is due at every multiple of P seconds since the origin, the single one-shot timer
+ *  is armed for the closest multiple among all the jobs.
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "scheduler.h"
+
+//max number of periodic jobs
+#define SCHEDULER_MAX_JOBS					8
+
+struct scheduler_Job
+{
+	const char*				namePtr;
+	uint32_t				periodSec;			//0 : suspended
+	scheduler_JobFunc_t		funcPtr;
+	void*					contextPtr;
+};
+
+static struct scheduler_Job		_jobs[SCHEDULER_MAX_JOBS];
+static size_t					_jobCount = 0;
+static le_timer_Ref_t			_schedulerTimerRef = NULL;
+static le_clk_Time_t			_schedulerOrigin;
+static uint64_t					_lastTick = 0;			//seconds since the origin, when jobs were last run
+
+
+//milliseconds elapsed since the origin
+static uint64_t GetElapsedMs()
+{
+	le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), _schedulerOrigin);
+
+	return (uint64_t)elapsed.sec * 1000 + elapsed.usec / 1000;
+}
+
+//arm the timer for the next tick at which a job is due
+static void ArmTimer()
+{
+	uint64_t	nextTick = 0;
+	size_t		i;
+
+	for (i = 0; i < _jobCount; i++)
+	{
+		if (_jobs[i].periodSec)
+		{
+			uint64_t jobTick = (_lastTick / _jobs[i].periodSec + 1) * _jobs[i].periodSec;
+
+			if ((0 == nextTick) || (jobTick < nextTick))
+			{
+				nextTick = jobTick;
+			}
+		}
+	}
+
+	le_timer_Stop(_schedulerTimerRef);
+
+	if (nextTick)
+	{
+		uint64_t	elapsedMs = GetElapsedMs();
+		uint64_t	dueMs = nextTick * 1000;
+
+		le_timer_SetMsInterval(_schedulerTimerRef, (dueMs > elapsedMs) ? (uint32_t)(dueMs - elapsedMs) : 1);
+		le_timer_Start(_schedulerTimerRef);
+	}
+}
+
+//timer expiry : run every job due since the last wakeup, once
+static void OnTick(le_timer_Ref_t timerRef)
+{
+	uint64_t	tick = GetElapsedMs() / 1000;
+	size_t		i;
+
+	for (i = 0; i < _jobCount; i++)
+	{
+		uint32_t period = _jobs[i].periodSec;
+
+		//a wakeup delayed past several multiples still runs the job only once
+		if (period && (tick / period > _lastTick / period))
+		{
+			_jobs[i].funcPtr(_jobs[i].contextPtr);
+		}
+	}
+
+	_lastTick = tick;
+
+	ArmTimer();
+}
+
+//add a periodic job
+scheduler_JobRef_t scheduler_AddJob(const char* namePtr, uint32_t periodSec, scheduler_JobFunc_t funcPtr, void* contextPtr)
+{
+	if (_jobCount >= SCHEDULER_MAX_JOBS)
+	{
+		LE_ERROR("Too many periodic jobs, %s not added", namePtr);
+		return NULL;
+	}
+
+	if (NULL == _schedulerTimerRef)
+	{
+		_schedulerTimerRef = le_timer_Create("schedulerTimer");
+		le_timer_SetHandler(_schedulerTimerRef, OnTick);
+		_schedulerOrigin = le_clk_GetRelativeTime();
+		_lastTick = 0;
+	}
+
+	scheduler_JobRef_t jobRef = &_jobs[_jobCount++];
+
+	jobRef->namePtr = namePtr;
+	jobRef->periodSec = periodSec;
+	jobRef->funcPtr = funcPtr;
+	jobRef->contextPtr = contextPtr;
+
+	ArmTimer();
+
+	return jobRef;
+}
+
+//change the period of a job, it stays aligned on the origin
+void scheduler_SetJobPeriod(scheduler_JobRef_t jobRef, uint32_t periodSec)
+{
+	if ((NULL == jobRef) || (jobRef->periodSec == periodSec))
+	{
+		return;
+	}
+
+	LE_INFO("Job %s period is now %u seconds", jobRef->namePtr, periodSec);
+
+	jobRef->periodSec = periodSec;
+
+	ArmTimer();
+}
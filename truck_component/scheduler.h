@@ -0,0 +1,26 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file scheduler.h
+ *
+ * Helper lib running all the periodic jobs of the app from a single timer:
+ *      Job periods are aligned on a common time origin, jobs falling due together run in the same wakeup
+ *      Changing the period of a job keeps it aligned, there is no phase drift
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+//Periodic job
+typedef void (* scheduler_JobFunc_t) (void* contextPtr);
+
+typedef struct scheduler_Job* scheduler_JobRef_t;
+
+
+//Add a periodic job, jobs due in the same wakeup run in the order they were added. A period of 0 suspends the job
+scheduler_JobRef_t scheduler_AddJob(const char* namePtr, uint32_t periodSec, scheduler_JobFunc_t funcPtr, void* contextPtr);
+
+//Change the period of a job (seconds), 0 suspends the job
+void scheduler_SetJobPeriod(scheduler_JobRef_t jobRef, uint32_t periodSec);
+
+#endif //_SCHEDULER_H_
@@ -0,0 +1,272 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file session.c
+ *
+ * Helper lib owning the AirVantage session, shared by the app and the helper libs:
+ *      A single le_avdata session is requested, and its state is tracked
+ *      Pushes are held while the session is down, flush handlers push what was held in one burst when it is back
+ *      Pushes waiting for their callback are counted and capped : once the cap is reached the link is stalled,
+ *      new data is held the same way and flushed when a push completes
+ *      Each session has its own epoch : the callbacks of the pushes of a stopped session are not counted
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "session.h"
+#include "diag.h"
+
+//max number of flush handlers, and of stop handlers
+#define SESSION_MAX_FLUSH_HANDLERS			4
+#define SESSION_MAX_STOP_HANDLERS			4
+
+//default cap of pushes in flight
+#define SESSION_DEFAULT_MAX_IN_FLIGHT		4
+
+//max number of pushes in flight whose issue time is kept, for the push latency
+#define SESSION_MAX_TIMED_PUSHES			16
+
+typedef struct
+{
+	session_FlushHandlerFunc_t	handlerPtr;
+	void*						contextPtr;
+} session_FlushHandler_t;
+
+typedef struct
+{
+	session_StopHandlerFunc_t	handlerPtr;
+	void*						contextPtr;
+} session_StopHandler_t;
+
+static le_avdata_RequestSessionObjRef_t		_sessionRef = NULL;
+static le_avdata_SessionStateHandlerRef_t	_sessionStateHandlerRef = NULL;
+static bool									_sessionConnected = false;
+static session_FlushHandler_t				_flushHandlers[SESSION_MAX_FLUSH_HANDLERS];
+static size_t								_flushHandlerCount = 0;
+static session_StopHandler_t				_stopHandlers[SESSION_MAX_STOP_HANDLERS];
+static size_t								_stopHandlerCount = 0;
+static uint32_t								_epoch = 0;					//incremented each time the session stops
+static uint32_t								_inFlight = 0;
+static uint32_t								_maxInFlight = SESSION_DEFAULT_MAX_IN_FLIGHT;
+static bool									_stalled = false;
+static uint32_t								_stallCount = 0;
+static le_clk_Time_t						_stallTime;
+
+//issue times of the pushes in flight, oldest first : avcService calls the push callbacks in order
+static le_clk_Time_t						_issueTimes[SESSION_MAX_TIMED_PUSHES];
+static uint32_t								_issueHead = 0;
+static uint32_t								_issueCount = 0;
+
+
+//push everything held, in one burst
+static void RunFlushHandlers()
+{
+	size_t i;
+
+	for (i = 0; i < _flushHandlerCount; i++)
+	{
+		_flushHandlers[i].handlerPtr(_flushHandlers[i].contextPtr);
+	}
+}
+
+//forget about the pushes in flight
+static void RunStopHandlers()
+{
+	size_t i;
+
+	for (i = 0; i < _stopHandlerCount; i++)
+	{
+		_stopHandlers[i].handlerPtr(_stopHandlers[i].contextPtr);
+	}
+}
+
+
+//Callback function to handle AirVantage session state
+static void OnSessionStateChange
+(
+	le_avdata_SessionState_t sessionState,
+	void* contextPtr
+)
+{
+	bool wasConnected = _sessionConnected;
+
+	_sessionConnected = (LE_AVDATA_SESSION_STARTED == sessionState);
+
+	LE_INFO("AirVantage session %s", _sessionConnected ? "started" : "stopped");
+
+	if (_sessionConnected && !wasConnected)
+	{
+		//push everything held while disconnected
+		RunFlushHandlers();
+	}
+	else if (!_sessionConnected)
+	{
+		//avcService may drop the callbacks of the pushes pending at disconnection : the uplink starts afresh on reconnection
+		//instead of staying stalled, a callback of the stopped session still coming later is ignored, it has an older epoch
+		_epoch++;
+		_inFlight = 0;
+		_stalled = false;
+		_issueHead = 0;
+		_issueCount = 0;
+
+		RunStopHandlers();
+	}
+}
+
+//request the session with AirVantage, and track its state
+void session_Start()
+{
+	if (NULL == _sessionStateHandlerRef)
+	{
+		_sessionStateHandlerRef = le_avdata_AddSessionStateHandler(OnSessionStateChange, NULL);
+	}
+
+	if (NULL == _sessionRef)
+	{
+		_sessionRef = le_avdata_RequestSession();
+	}
+}
+
+//release the session with AirVantage
+void session_Stop()
+{
+	if (_sessionRef)
+	{
+		le_avdata_ReleaseSession(_sessionRef);
+		_sessionRef = NULL;
+	}
+
+	_sessionConnected = false;
+}
+
+//true if the session is up
+bool session_IsConnected()
+{
+	return _sessionConnected;
+}
+
+//true if the session is up and the cap of pushes in flight is not reached
+bool session_CanPush()
+{
+	if (!_sessionConnected)
+	{
+		return false;
+	}
+
+	if (_inFlight >= _maxInFlight)
+	{
+		if (!_stalled)
+		{
+			_stalled = true;
+			_stallCount++;
+			_stallTime = le_clk_GetRelativeTime();
+			LE_WARN("Uplink stalled : %u pushes waiting for their callback, holding new data", _inFlight);
+		}
+
+		return false;
+	}
+
+	return true;
+}
+
+//epoch of the current session
+uint32_t session_GetEpoch()
+{
+	return _epoch;
+}
+
+//a push has been issued
+void session_PushIssued()
+{
+	_inFlight++;
+
+	if (_issueCount < SESSION_MAX_TIMED_PUSHES)
+	{
+		_issueTimes[(_issueHead + _issueCount) % SESSION_MAX_TIMED_PUSHES] = le_clk_GetRelativeTime();
+		_issueCount++;
+	}
+}
+
+//the callback of a push has been called, false if the push belongs to a stopped session
+bool session_PushCompleted(uint32_t epoch, bool bSuccess)
+{
+	if (epoch != _epoch)
+	{
+		return false;
+	}
+
+	if (_inFlight)
+	{
+		_inFlight--;
+	}
+
+	if (_issueCount)
+	{
+		diag_AddPush(_issueTimes[_issueHead], bSuccess);
+		_issueHead = (_issueHead + 1) % SESSION_MAX_TIMED_PUSHES;
+		_issueCount--;
+	}
+
+	if (_stalled && (_inFlight < _maxInFlight))
+	{
+		_stalled = false;
+		LE_INFO("Uplink resumed after %ld seconds", (long)le_clk_Sub(le_clk_GetRelativeTime(), _stallTime).sec);
+
+		//push what was held meanwhile
+		if (_sessionConnected)
+		{
+			RunFlushHandlers();
+		}
+	}
+
+	return true;
+}
+
+//set the cap of pushes in flight
+void session_SetMaxInFlight(uint32_t maxInFlight)
+{
+	_maxInFlight = (maxInFlight > 0) ? maxInFlight : 1;
+}
+
+//number of pushes in flight
+uint32_t session_GetInFlight()
+{
+	return _inFlight;
+}
+
+//number of times the cap of pushes in flight was reached
+uint32_t session_GetStallCount()
+{
+	return _stallCount;
+}
+
+//register a handler called when the session is (re)started
+le_result_t session_AddFlushHandler(session_FlushHandlerFunc_t handlerPtr, void* contextPtr)
+{
+	if (_flushHandlerCount >= SESSION_MAX_FLUSH_HANDLERS)
+	{
+		return LE_OVERFLOW;
+	}
+
+	_flushHandlers[_flushHandlerCount].handlerPtr = handlerPtr;
+	_flushHandlers[_flushHandlerCount].contextPtr = contextPtr;
+	_flushHandlerCount++;
+
+	return LE_OK;
+}
+
+//register a handler called when the session stops
+le_result_t session_AddStopHandler(session_StopHandlerFunc_t handlerPtr, void* contextPtr)
+{
+	if (_stopHandlerCount >= SESSION_MAX_STOP_HANDLERS)
+	{
+		return LE_OVERFLOW;
+	}
+
+	_stopHandlers[_stopHandlerCount].handlerPtr = handlerPtr;
+	_stopHandlers[_stopHandlerCount].contextPtr = contextPtr;
+	_stopHandlerCount++;
+
+	return LE_OK;
+}
@@ -0,0 +1,59 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file session.h
+ *
+ * Helper lib owning the AirVantage session, shared by the app and the helper libs:
+ *      A single le_avdata session is requested, and its state is tracked
+ *      Pushes are held while the session is down, flush handlers push what was held in one burst when it is back
+ *      Pushes waiting for their callback are counted and capped : once the cap is reached the link is stalled,
+ *      new data is held the same way and flushed when a push completes
+ *      Each session has its own epoch : the callbacks of the pushes of a stopped session are not counted
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _SESSION_H_
+#define _SESSION_H_
+
+//Called when the session is (re)started, to push the data held meanwhile
+typedef void (* session_FlushHandlerFunc_t) (void* contextPtr);
+
+//Called when the session stops : avcService may drop the callbacks of the pushes in flight
+typedef void (* session_StopHandlerFunc_t) (void* contextPtr);
+
+
+//Call this function first to request the session with AirVantage
+void session_Start();
+
+//Call this function when exiting the app to release the session
+void session_Stop();
+
+//true if the session is up
+bool session_IsConnected();
+
+//true if a push can be issued : the session is up and the cap of pushes in flight is not reached
+//otherwise hold the data and push it from a flush handler
+bool session_CanPush();
+
+//Epoch of the current session, to be given to the push callback, and back to session_PushCompleted
+uint32_t session_GetEpoch();
+
+//Call when a push has been issued (le_avdata_Push/PushRecord returned LE_OK), and when its callback is called
+//the time in between is reported as the push latency
+//session_PushCompleted is given the epoch of the push : false if it was issued in a stopped session, it is not counted
+void session_PushIssued();
+bool session_PushCompleted(uint32_t epoch, bool bSuccess);
+
+//Cap of pushes in flight
+void session_SetMaxInFlight(uint32_t maxInFlight);
+
+//Number of pushes in flight, and number of times the cap was reached
+uint32_t session_GetInFlight();
+uint32_t session_GetStallCount();
+
+//Register a handler to be called each time the session is (re)started
+le_result_t session_AddFlushHandler(session_FlushHandlerFunc_t handlerPtr, void* contextPtr);
+
+//Register a handler to be called each time the session stops, to forget about the pushes in flight
+le_result_t session_AddStopHandler(session_StopHandlerFunc_t handlerPtr, void* contextPtr);
+
+#endif //_SESSION_H_
@@ -0,0 +1,326 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file store.c
+ *
+ * Helper lib keeping timeserie samples on flash until AirVantage acknowledged them (store-and-forward):
+ *      Samples are appended to a bounded ring file, the oldest samples are dropped when the ring is full
+ *      Each slot carries a sequence number and a CRC, a slot torn by a crash is ignored on restart
+ *      The acknowledged position is saved aside with an atomic rename, the directory is synced after it
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "store.h"
+
+//suffix of the file holding the acknowledged position
+#define STORE_ACK_SUFFIX				".ack"
+#define STORE_TMP_SUFFIX				".tmp"
+
+#define STORE_PATH_MAX					128
+
+//one sample on flash, slot index = seq % capacity
+typedef struct
+{
+	uint32_t	seq;
+	uint32_t	resourceId;
+	uint64_t	timestamp;
+	double		value;
+	uint32_t	crc;				//crc32 of the fields above
+	uint32_t	reserved;
+} StoreSlot_t;
+
+static int						_storeFd = -1;
+static char						_storeAckPath[STORE_PATH_MAX];
+static uint32_t					_storeCapacity = 0;
+static uint32_t					_storeHeadSeq = 1;			//next sequence number to be written
+static uint32_t					_storeAckSeq = 1;			//every sample before this one is acknowledged
+static uint32_t					_storeDropCount = 0;
+
+
+//crc32 (IEEE 802.3) of a buffer
+static uint32_t Crc32(const void* dataPtr, size_t size)
+{
+	const uint8_t*	bytePtr = dataPtr;
+	uint32_t		crc = 0xFFFFFFFF;
+
+	while (size--)
+	{
+		int bit;
+
+		crc ^= *bytePtr++;
+		for (bit = 0; bit < 8; bit++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+
+	return ~crc;
+}
+
+//read a slot, true if it holds a valid sample
+static bool ReadSlot(uint32_t index, StoreSlot_t* slotPtr)
+{
+	off_t offset = (off_t)index * sizeof(StoreSlot_t);
+
+	if (pread(_storeFd, slotPtr, sizeof(StoreSlot_t), offset) != sizeof(StoreSlot_t))
+	{
+		return false;
+	}
+
+	return (slotPtr->crc == Crc32(slotPtr, offsetof(StoreSlot_t, crc))) &&
+		   (slotPtr->seq % _storeCapacity == index);
+}
+
+//flush the directory of the ack file, so that its rename survives a power loss
+static void SyncAckDir()
+{
+	char	dirPath[STORE_PATH_MAX];
+	char*	slashPtr;
+
+	snprintf(dirPath, sizeof(dirPath), "%s", _storeAckPath);
+	slashPtr = strrchr(dirPath, '/');
+
+	if (NULL == slashPtr)
+	{
+		snprintf(dirPath, sizeof(dirPath), ".");
+	}
+	else
+	{
+		*(slashPtr == dirPath ? slashPtr + 1 : slashPtr) = '\0';
+	}
+
+	int fd = open(dirPath, O_RDONLY | O_DIRECTORY);
+	if ((fd < 0) || (fsync(fd) != 0))
+	{
+		LE_ERROR("Cannot sync store directory %s (%s)", dirPath, strerror(errno));
+	}
+
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+}
+
+//save the acknowledged position : written aside then renamed, so that a crash leaves either the old or the new one
+//the directory is synced after the rename, for the new position to survive a power loss
+static void SaveAck()
+{
+	char	tmpPath[STORE_PATH_MAX + sizeof(STORE_TMP_SUFFIX)];
+
+	snprintf(tmpPath, sizeof(tmpPath), "%s%s", _storeAckPath, STORE_TMP_SUFFIX);
+
+	int fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0)
+	{
+		LE_ERROR("Cannot save store position (%s)", strerror(errno));
+		return;
+	}
+
+	if ((write(fd, &_storeAckSeq, sizeof(_storeAckSeq)) != sizeof(_storeAckSeq)) || (fsync(fd) != 0))
+	{
+		LE_ERROR("Cannot save store position (%s)", strerror(errno));
+		close(fd);
+		return;
+	}
+
+	close(fd);
+
+	if (rename(tmpPath, _storeAckPath) != 0)
+	{
+		LE_ERROR("Cannot save store position (%s)", strerror(errno));
+		return;
+	}
+
+	SyncAckDir();
+}
+
+//load the acknowledged position, 0 if none
+static uint32_t LoadAck()
+{
+	uint32_t	ackSeq = 0;
+	int			fd = open(_storeAckPath, O_RDONLY);
+
+	if (fd >= 0)
+	{
+		if (read(fd, &ackSeq, sizeof(ackSeq)) != sizeof(ackSeq))
+		{
+			ackSeq = 0;
+		}
+		close(fd);
+	}
+
+	return ackSeq;
+}
+
+//open (or create) the store, and recover the pending samples of a previous run
+le_result_t store_Open(const char* pathPtr, uint32_t capacity)
+{
+	if ((capacity == 0) || (strlen(pathPtr) + sizeof(STORE_ACK_SUFFIX) > STORE_PATH_MAX))
+	{
+		return LE_BAD_PARAMETER;
+	}
+
+	_storeFd = open(pathPtr, O_RDWR | O_CREAT, 0600);
+	if (_storeFd < 0)
+	{
+		LE_ERROR("Cannot open store %s (%s)", pathPtr, strerror(errno));
+		return LE_IO_ERROR;
+	}
+
+	snprintf(_storeAckPath, sizeof(_storeAckPath), "%s%s", pathPtr, STORE_ACK_SUFFIX);
+	_storeCapacity = capacity;
+
+	//a ring of another capacity cannot be indexed, restart from scratch
+	struct stat st;
+	if ((fstat(_storeFd, &st) != 0) || (st.st_size != (off_t)capacity * (off_t)sizeof(StoreSlot_t)))
+	{
+		LE_INFO("Creating store %s (%u samples)", pathPtr, capacity);
+		if (ftruncate(_storeFd, 0) != 0 || ftruncate(_storeFd, (off_t)capacity * sizeof(StoreSlot_t)) != 0)
+		{
+			LE_ERROR("Cannot size store %s (%s)", pathPtr, strerror(errno));
+			close(_storeFd);
+			_storeFd = -1;
+			return LE_IO_ERROR;
+		}
+		unlink(_storeAckPath);
+	}
+
+	//the head is right after the most recent valid slot
+	uint32_t	index;
+	uint32_t	lastSeq = 0;
+	StoreSlot_t	slot;
+
+	for (index = 0; index < capacity; index++)
+	{
+		if (ReadSlot(index, &slot) && (slot.seq > lastSeq))
+		{
+			lastSeq = slot.seq;
+		}
+	}
+
+	_storeHeadSeq = lastSeq + 1;
+	_storeAckSeq = LoadAck();
+
+	//older samples have been overwritten by the ring
+	if (_storeHeadSeq > capacity && _storeAckSeq < _storeHeadSeq - capacity)
+	{
+		_storeAckSeq = _storeHeadSeq - capacity;
+	}
+	if (_storeAckSeq < 1 || _storeAckSeq > _storeHeadSeq)
+	{
+		_storeAckSeq = (_storeHeadSeq > capacity) ? _storeHeadSeq - capacity : 1;
+	}
+
+	LE_INFO("Store %s : %zu pending samples", pathPtr, store_GetCount());
+
+	return LE_OK;
+}
+
+//close the store
+void store_Close()
+{
+	if (_storeFd >= 0)
+	{
+		close(_storeFd);
+		_storeFd = -1;
+	}
+}
+
+//append samples, the oldest pending samples are dropped if the ring is full
+le_result_t store_Append(const store_Sample_t* samplesPtr, size_t count)
+{
+	if (_storeFd < 0)
+	{
+		return LE_NOT_POSSIBLE;
+	}
+
+	size_t i;
+
+	for (i = 0; i < count; i++)
+	{
+		StoreSlot_t slot = {0};
+
+		slot.seq = _storeHeadSeq;
+		slot.resourceId = samplesPtr[i].resourceId;
+		slot.timestamp = samplesPtr[i].timestamp;
+		slot.value = samplesPtr[i].value;
+		slot.crc = Crc32(&slot, offsetof(StoreSlot_t, crc));
+
+		off_t offset = (off_t)(slot.seq % _storeCapacity) * sizeof(StoreSlot_t);
+
+		if (pwrite(_storeFd, &slot, sizeof(slot), offset) != sizeof(slot))
+		{
+			LE_ERROR("Cannot write store (%s)", strerror(errno));
+			return LE_IO_ERROR;
+		}
+
+		_storeHeadSeq++;
+
+		if (_storeHeadSeq - _storeAckSeq > _storeCapacity)
+		{
+			_storeAckSeq = _storeHeadSeq - _storeCapacity;
+			_storeDropCount++;
+		}
+	}
+
+	if (fdatasync(_storeFd) != 0)
+	{
+		LE_ERROR("Cannot sync store (%s)", strerror(errno));
+		return LE_IO_ERROR;
+	}
+
+	return LE_OK;
+}
+
+//copy the oldest pending samples
+size_t store_Peek(store_Sample_t* samplesPtr, size_t maxCount, uint32_t* nextSeqPtr)
+{
+	size_t		count = 0;
+	uint32_t	seq = _storeAckSeq;
+
+	if (_storeFd >= 0)
+	{
+		for ( ; (seq < _storeHeadSeq) && (count < maxCount); seq++)
+		{
+			StoreSlot_t slot;
+
+			//a torn slot is skipped
+			if (ReadSlot(seq % _storeCapacity, &slot) && (slot.seq == seq))
+			{
+				samplesPtr[count].timestamp = slot.timestamp;
+				samplesPtr[count].resourceId = slot.resourceId;
+				samplesPtr[count].value = slot.value;
+				count++;
+			}
+		}
+	}
+
+	*nextSeqPtr = seq;
+
+	return count;
+}
+
+//acknowledge every sample before nextSeq
+void store_Ack(uint32_t nextSeq)
+{
+	//samples dropped meanwhile may already be past this position
+	if (nextSeq > _storeAckSeq && nextSeq <= _storeHeadSeq)
+	{
+		_storeAckSeq = nextSeq;
+		SaveAck();
+	}
+}
+
+//number of pending samples
+size_t store_GetCount()
+{
+	return _storeHeadSeq - _storeAckSeq;
+}
+
+//number of samples dropped because the store was full
+uint32_t store_GetDropCount()
+{
+	return _storeDropCount;
+}
@@ -0,0 +1,45 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file store.h
+ *
+ * Helper lib keeping timeserie samples on flash until AirVantage acknowledged them (store-and-forward):
+ *      Samples are appended to a bounded ring file, the oldest samples are dropped when the ring is full
+ *      Each slot carries a sequence number and a CRC, a slot torn by a crash is ignored on restart
+ *      The acknowledged position is saved aside with an atomic rename, the directory is synced after it
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _STORE_H_
+#define _STORE_H_
+
+//A timeserie sample, the resource id is defined by the app
+typedef struct
+{
+	uint64_t	timestamp;			//UTC in milliseconds
+	uint32_t	resourceId;
+	double		value;
+} store_Sample_t;
+
+
+//Call this function first to open (or create) the store, pending samples of a previous run are recovered
+le_result_t store_Open(const char* pathPtr, uint32_t capacity);
+
+//Call this function when exiting the app
+void store_Close();
+
+//Append samples to the store, LE_OK once they are on flash
+le_result_t store_Append(const store_Sample_t* samplesPtr, size_t count);
+
+//Copy up to maxCount of the oldest pending samples, nextSeqPtr receives the position to pass to store_Ack() once they are delivered
+size_t store_Peek(store_Sample_t* samplesPtr, size_t maxCount, uint32_t* nextSeqPtr);
+
+//Acknowledge every sample before the given position
+void store_Ack(uint32_t nextSeq);
+
+//Number of pending samples
+size_t store_GetCount();
+
+//Number of samples dropped because the store was full
+uint32_t store_GetDropCount();
+
+#endif //_STORE_H_
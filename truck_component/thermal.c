@@ -0,0 +1,102 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file thermal.c
+ *
+ * Helper lib simulating the temperature of cooled compartments, shared by the truck and the fleet load generator:
+ *      A compartment converges to its target temperature while cooled (fan on, door closed), to the outside temperature otherwise
+ *      The model is advanced by the elapsed time in closed form : any gap costs the same, whatever the sampling interval
+ *      The state is kept in one array per field, an advance sweeps every compartment in one loop
+ *
+ *  The temperature moves at THERMAL_TEMP_RATE toward the temp it converges to, and stays there once reached.
+ *  The fan duration is kept with its fraction, the published int is its rounded value, capped at INT_MAX.
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+#include <math.h>
+#include <limits.h>
+
+#include "thermal.h"
+
+
+//move a temperature toward a target by at most maxDelta, without overshooting it
+static double Converge(double value, double target, double maxDelta)
+{
+	if (value < target)
+	{
+		return (target - value > maxDelta) ? value + maxDelta : target;
+	}
+
+	return (value - target > maxDelta) ? value - maxDelta : target;
+}
+
+//add fanSec seconds of fan on to the duration of compartment i
+static void AddFanDuration(const thermal_Zones_t* zonesPtr, size_t i, double fanSec)
+{
+	double duration = zonesPtr->fanDurationRawPtr[i] + fanSec * THERMAL_FAN_DURATION_RATE;
+
+	if (duration > INT_MAX)
+	{
+		duration = INT_MAX;
+	}
+
+	zonesPtr->fanDurationRawPtr[i] = duration;
+	zonesPtr->fanDurationPtr[i] = (int)lround(duration);
+}
+
+//advance every compartment by the elapsed time, the fan shutoff at the target temp is found in closed form
+void thermal_Advance(const thermal_Zones_t* zonesPtr, size_t count, double outsideTemp, double elapsedSec, double* convergedToPtr, bool* stoppedPtr)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++)
+	{
+		double	temperature = zonesPtr->temperaturePtr[i];
+		double	target = zonesPtr->targetPtr[i];
+		double	warmingSec = elapsedSec;
+		bool	cooled = zonesPtr->fanIsOnPtr[i] && !zonesPtr->doorIsOpenPtr[i];
+
+		convergedToPtr[i] = cooled ? target : outsideTemp;
+		stoppedPtr[i] = false;
+
+		if (cooled)
+		{
+			//time to reach the target temp, the fan stops then
+			double coolingSec = (temperature > target) ? (temperature - target) / THERMAL_TEMP_RATE : 0;
+
+			if (coolingSec > elapsedSec)
+			{
+				coolingSec = elapsedSec;
+			}
+			else
+			{
+				zonesPtr->fanIsOnPtr[i] = false;
+				stoppedPtr[i] = true;
+			}
+
+			temperature = Converge(temperature, target, coolingSec * THERMAL_TEMP_RATE);
+			AddFanDuration(zonesPtr, i, coolingSec);
+			warmingSec = elapsedSec - coolingSec;
+		}
+		else if (zonesPtr->fanIsOnPtr[i])
+		{
+			//the door is open, the fan runs for nothing
+			AddFanDuration(zonesPtr, i, elapsedSec);
+		}
+
+		if (!zonesPtr->fanIsOnPtr[i] || zonesPtr->doorIsOpenPtr[i])
+		{
+			temperature = Converge(temperature, outsideTemp, warmingSec * THERMAL_TEMP_RATE);
+		}
+
+		zonesPtr->temperaturePtr[i] = temperature;
+	}
+}
+
+//reset the fan duration of a compartment, with its fraction
+void thermal_ResetFanDuration(const thermal_Zones_t* zonesPtr, size_t i)
+{
+	zonesPtr->fanDurationRawPtr[i] = 0;
+	zonesPtr->fanDurationPtr[i] = 0;
+}
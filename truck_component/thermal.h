@@ -0,0 +1,40 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file thermal.h
+ *
+ * Helper lib simulating the temperature of cooled compartments, shared by the truck and the fleet load generator:
+ *      A compartment converges to its target temperature while cooled (fan on, door closed), to the outside temperature otherwise
+ *      The model is advanced by the elapsed time in closed form : any gap costs the same, whatever the sampling interval
+ *      The state is kept in one array per field, an advance sweeps every compartment in one loop
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _THERMAL_H_
+#define _THERMAL_H_
+
+#define THERMAL_TEMP_RATE					0.08        //temperature change per second (°C), 0.4 per 5 seconds
+#define THERMAL_FAN_DURATION_RATE			1.0         //fan duration increment per second of fan on
+
+//Cooled compartments, one array per field
+typedef struct
+{
+	double*		temperaturePtr;			//current temp
+	double*		targetPtr;				//target temp while cooled
+	int*		fanDurationPtr;			//published fan duration, rounded
+	double*		fanDurationRawPtr;		//fan duration with its fraction : short advances add up
+	bool*		fanIsOnPtr;
+	bool*		doorIsOpenPtr;
+} thermal_Zones_t;
+
+
+//Advance count compartments by elapsedSec seconds, the fan duration grows while the fan is on
+//A cooled compartment reaching its target temp within the gap gets its fan turned off at that time, then warms up for the rest of the gap :
+//its fan is off on return and stoppedPtr is set, so that the caller can switch the fan
+//the temp each compartment converged to at the start of the gap is returned in convergedToPtr
+//convergedToPtr and stoppedPtr : count elements
+void thermal_Advance(const thermal_Zones_t* zonesPtr, size_t count, double outsideTemp, double elapsedSec, double* convergedToPtr, bool* stoppedPtr);
+
+//Reset the fan duration of compartment i
+void thermal_ResetFanDuration(const thermal_Zones_t* zonesPtr, size_t i);
+
+#endif //_THERMAL_H_
@@ -0,0 +1,132 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file trace.c
+ *
+ * Helper lib keeping the events of the hot paths in a fixed-size in-memory ring, instead of logging them:
+ *      An event is an id, a timestamp and a few numeric arguments : nothing is formatted when it is added
+ *      The ring is formatted to the log on demand only (truck.cmd.dumpTrace), the oldest events are overwritten
+ *
+ *  Events are added by the main thread and the worker : a slot is claimed by an atomic increment of the head.
+ *  Each slot carries the sequence number of its event, cleared while it is written : the dump skips a slot
+ *  whose sequence number is not the expected one, or changed while it was copied.
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "trace.h"
+
+//events kept in the ring, a power of 2
+#define TRACE_RING_SIZE						512
+#define TRACE_LINE_MAX						96
+
+typedef struct
+{
+	uint32_t				seq;				//sequence number of the event + 1, 0 while it is written
+	uint32_t				timeMs;				//relative time (milliseconds)
+	uint32_t				event;
+	int32_t					args[3];
+	const char*				textPtr;
+} TraceEntry_t;
+
+static TraceEntry_t					_traceRing[TRACE_RING_SIZE];
+static uint32_t						_traceHead = 0;				//events added since start
+
+//format of the arguments of each event
+static const char*					_traceFormats[TRACE_EVENT_COUNT] =
+{
+	[TRACE_EMULATE] =				"emulate : zone %d at %d m°C, converging to %d m°C",
+	[TRACE_FAN_STOPPED] =			"fan stopped : zone %d at %d m°C",
+	[TRACE_DOOR_SWITCH] =			"door switch : %d",
+	[TRACE_TEMP_ALARM] =			"temperature alarm : %d m°C above %d m°C",
+	[TRACE_WINDOW] =				"window summary : zone %d, %d..%d m°C",
+	[TRACE_ACCUMULATE] =			"accumulate : %d samples, timeserie %d samples, ~%d bytes",
+	[TRACE_TIMESERIE_PUSH] =		"timeserie push : %d samples, ~%d bytes, result %d",
+	[TRACE_TIMESERIE_ACK] =			"timeserie push status %d",
+	[TRACE_TIMESERIE_STORED] =		"timeserie stored : %d samples, %d pending",
+	[TRACE_STATE_PUSH] =			"state push : 0x%x, result %d",
+	[TRACE_STATE_ACK] =				"state push status %d",
+	[TRACE_REPLAY_PUSH] =			"replay push : %d samples",
+	[TRACE_REPLAY_ACK] =			"replay push status %d, %d samples pending",
+	[TRACE_LOCATION_READ] =			"location read : fix state %d, latitude %d, longitude %d",
+	[TRACE_LOCATION_PUSH] =			"location push : result %d, accuracy %d",
+	[TRACE_LOCATION_ACK] =			"location push status %d",
+	[TRACE_GPIO_READ] =				"GPIO_%d - CF3-Pin%d - Read : %d",
+	[TRACE_GPIO_IS_INPUT] =			"GPIO_%d - CF3-Pin%d - IsInput : %d",
+	[TRACE_GPIO_POLARITY] =			"GPIO_%d - CF3-Pin%d - active high : %d",
+	[TRACE_GPIO_PULL] =				"GPIO_%d - CF3-Pin%d - pull up/down : %d",
+	[TRACE_GPIO_EDGE] =				"GPIO_%d - CF3-Pin%d - edge sense : %d",
+	[TRACE_SETTING] =				"setting : value %d, changed %d",
+	[TRACE_COMMAND] =				"command : executed in %d us",
+};
+
+
+//Add an event naming a resource, textPtr must outlive the ring
+void trace_AddText(trace_Event_t event, const char* textPtr, int32_t arg0, int32_t arg1, int32_t arg2)
+{
+	le_clk_Time_t	now = le_clk_GetRelativeTime();
+	uint32_t		seq = __atomic_fetch_add(&_traceHead, 1, __ATOMIC_RELAXED);
+	TraceEntry_t*	entryPtr = &_traceRing[seq % TRACE_RING_SIZE];
+
+	//the slot is invalid until it is fully written
+	__atomic_store_n(&entryPtr->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	entryPtr->timeMs = (uint32_t)(now.sec * 1000 + now.usec / 1000);
+	entryPtr->event = event;
+	entryPtr->args[0] = arg0;
+	entryPtr->args[1] = arg1;
+	entryPtr->args[2] = arg2;
+	entryPtr->textPtr = textPtr;
+
+	__atomic_store_n(&entryPtr->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+//Add an event to the ring
+void trace_Add(trace_Event_t event, int32_t arg0, int32_t arg1, int32_t arg2)
+{
+	trace_AddText(event, NULL, arg0, arg1, arg2);
+}
+
+//Number of events added since start
+uint32_t trace_GetCount()
+{
+	return __atomic_load_n(&_traceHead, __ATOMIC_RELAXED);
+}
+
+//Format the events of the ring to the log, oldest first
+void trace_Dump()
+{
+	uint32_t	head = __atomic_load_n(&_traceHead, __ATOMIC_ACQUIRE);
+	uint32_t	seq = (head > TRACE_RING_SIZE) ? head - TRACE_RING_SIZE : 0;
+	uint32_t	dumped = 0;
+	char		line[TRACE_LINE_MAX];
+
+	for ( ; seq != head; seq++)
+	{
+		const TraceEntry_t* entryPtr = &_traceRing[seq % TRACE_RING_SIZE];
+
+		if (__atomic_load_n(&entryPtr->seq, __ATOMIC_ACQUIRE) != seq + 1)
+		{
+			continue;
+		}
+
+		TraceEntry_t entry = *entryPtr;
+
+		//overwritten while it was copied
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if ((__atomic_load_n(&entryPtr->seq, __ATOMIC_RELAXED) != seq + 1) || (entry.event >= TRACE_EVENT_COUNT))
+		{
+			continue;
+		}
+
+		snprintf(line, sizeof(line), _traceFormats[entry.event], entry.args[0], entry.args[1], entry.args[2]);
+
+		LE_INFO("[%" PRIu32 ".%03" PRIu32 "] %s%s%s", entry.timeMs / 1000, entry.timeMs % 1000, line,
+				entry.textPtr ? " - " : "", entry.textPtr ? entry.textPtr : "");
+		dumped++;
+	}
+
+	LE_INFO("Trace : %" PRIu32 " events since start, %" PRIu32 " dumped", head, dumped);
+}
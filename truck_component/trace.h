@@ -0,0 +1,59 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file trace.h
+ *
+ * Helper lib keeping the events of the hot paths in a fixed-size in-memory ring, instead of logging them:
+ *      An event is an id, a timestamp and a few numeric arguments : nothing is formatted when it is added
+ *      The ring is formatted to the log on demand only (truck.cmd.dumpTrace), the oldest events are overwritten
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+//Events of the trace, their arguments are given in the format table of trace.c
+//temperatures are in milli °C, coordinates in micro degrees
+typedef enum
+{
+	TRACE_EMULATE = 0,				//zone, temperature, temperature converged to
+	TRACE_FAN_STOPPED,				//zone, temperature
+	TRACE_DOOR_SWITCH,				//level
+	TRACE_TEMP_ALARM,				//temperature, alarm limit
+	TRACE_WINDOW,					//zone, min temperature, max temperature
+	TRACE_ACCUMULATE,				//samples, samples in the timeserie, bytes of the timeserie
+	TRACE_TIMESERIE_PUSH,			//samples, bytes, le_result_t
+	TRACE_TIMESERIE_ACK,			//le_avdata_PushStatus_t
+	TRACE_TIMESERIE_STORED,			//samples, samples pending
+	TRACE_STATE_PUSH,				//state mask, le_result_t
+	TRACE_STATE_ACK,				//le_avdata_PushStatus_t
+	TRACE_REPLAY_PUSH,				//samples
+	TRACE_REPLAY_ACK,				//le_avdata_PushStatus_t, samples pending
+	TRACE_LOCATION_READ,			//fix state, latitude, longitude
+	TRACE_LOCATION_PUSH,			//le_result_t, horizontal accuracy
+	TRACE_LOCATION_ACK,				//le_avdata_PushStatus_t
+	TRACE_GPIO_READ,				//GPIO, CF3 pin, level
+	TRACE_GPIO_IS_INPUT,			//GPIO, CF3 pin, input
+	TRACE_GPIO_POLARITY,			//GPIO, CF3 pin, active high
+	TRACE_GPIO_PULL,				//GPIO, CF3 pin, gpio_iot_PullUpDown_t
+	TRACE_GPIO_EDGE,				//GPIO, CF3 pin, gpio_iot_Edge_t
+	TRACE_SETTING,					//text : path, value (milli for a float), changed
+	TRACE_COMMAND,					//text : path, latency (microseconds)
+	TRACE_EVENT_COUNT
+} trace_Event_t;
+
+//a float argument, in milli units
+#define TRACE_MILLI(value)					((int32_t)((value) * 1000))
+
+//Add an event to the ring, from any thread : no formatting, no IPC, no allocation
+void trace_Add(trace_Event_t event, int32_t arg0, int32_t arg1, int32_t arg2);
+
+//Add an event naming a resource : textPtr is kept as is, it must outlive the ring (literal or static path)
+void trace_AddText(trace_Event_t event, const char* textPtr, int32_t arg0, int32_t arg1, int32_t arg2);
+
+//Number of events added since start, including the overwritten ones
+uint32_t trace_GetCount();
+
+//Format the events of the ring to the log, oldest first
+void trace_Dump();
+
+#endif //_TRACE_H_
@@ -0,0 +1,109 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file uplink.c
+ *
+ * Helper lib deciding when the non-urgent uploads (timeseries, replay of stored samples) can go, from the radio conditions:
+ *      The signal quality and radio access technology in use are read from le_mrc, at most every few seconds
+ *      While the signal is poor, an upload is held until the radio improves, or until its oldest data reaches the max delay
+ *
+ *  A push on a weak signal is retransmitted many times : holding it costs nothing but latency, the held data goes
+ *  in one transfer once the radio is back. Urgent data (state changes, alarms) does not ask this lib.
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "uplink.h"
+
+//the radio state is read again when it is older than this (seconds)
+#define UPLINK_RADIO_POLL_SEC				10
+
+static uint32_t					_uplinkMinQuality = 0;
+static uint32_t					_uplinkMaxDelay = 0;
+static bool						_uplinkRadioRead = false;		//the radio state has been read once
+static time_t					_uplinkReadTime = 0;			//relative time of the last read (seconds)
+static int32_t					_uplinkQuality = -1;
+static le_mrc_Rat_t				_uplinkRat = LE_MRC_RAT_UNKNOWN;
+static bool						_uplinkGood = true;
+
+
+//name of a radio access technology, for the logs
+static const char* GetRatName(le_mrc_Rat_t rat)
+{
+	switch (rat)
+	{
+		case LE_MRC_RAT_GSM:		return "GSM";
+		case LE_MRC_RAT_UMTS:		return "UMTS";
+		case LE_MRC_RAT_TDSCDMA:	return "TD-SCDMA";
+		case LE_MRC_RAT_LTE:		return "LTE";
+		case LE_MRC_RAT_CDMA:		return "CDMA";
+		default:					return "none";
+	}
+}
+
+//read the radio state from le_mrc, unless it was read recently
+static void ReadRadio()
+{
+	time_t		now = le_clk_GetRelativeTime().sec;
+	uint32_t	quality = 0;
+	le_mrc_Rat_t rat = LE_MRC_RAT_UNKNOWN;
+
+	if (_uplinkRadioRead && ((now - _uplinkReadTime) < UPLINK_RADIO_POLL_SEC))
+	{
+		return;
+	}
+
+	_uplinkRadioRead = true;
+	_uplinkReadTime = now;
+	_uplinkQuality = (LE_OK == le_mrc_GetSignalQual(&quality)) ? (int32_t)quality : -1;
+	_uplinkRat = (LE_OK == le_mrc_GetRadioAccessTechInUse(&rat)) ? rat : LE_MRC_RAT_UNKNOWN;
+
+	bool good = (LE_MRC_RAT_UNKNOWN != _uplinkRat) && (_uplinkQuality >= (int32_t)_uplinkMinQuality);
+
+	if (good != _uplinkGood)
+	{
+		LE_INFO("Radio %s, quality %d : uploads %s", GetRatName(_uplinkRat), _uplinkQuality, good ? "resumed" : "held");
+		_uplinkGood = good;
+	}
+}
+
+//Signal quality below which the non-urgent uploads are held
+void uplink_SetMinQuality(uint32_t quality)
+{
+	_uplinkMinQuality = quality;
+
+	//read again with the new threshold
+	_uplinkRadioRead = false;
+}
+
+//Longest time the oldest data of an upload can be held
+void uplink_SetMaxDelay(uint32_t delaySec)
+{
+	_uplinkMaxDelay = delaySec;
+}
+
+//true if the radio is good enough for a non-urgent upload
+bool uplink_IsGood()
+{
+	if (0 == _uplinkMinQuality)
+	{
+		return true;
+	}
+
+	ReadRadio();
+
+	return _uplinkGood;
+}
+
+//true if a non-urgent upload can go now
+bool uplink_CanUpload(uint32_t ageSec)
+{
+	return (_uplinkMaxDelay && (ageSec >= _uplinkMaxDelay)) || uplink_IsGood();
+}
+
+//Last signal quality read
+int32_t uplink_GetSignalQuality()
+{
+	return _uplinkQuality;
+}
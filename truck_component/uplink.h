@@ -0,0 +1,29 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file uplink.h
+ *
+ * Helper lib deciding when the non-urgent uploads (timeseries, replay of stored samples) can go, from the radio conditions:
+ *      The signal quality and radio access technology in use are read from le_mrc, at most every few seconds
+ *      While the signal is poor, an upload is held until the radio improves, or until its oldest data reaches the max delay
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _UPLINK_H_
+#define _UPLINK_H_
+
+//Signal quality (le_mrc, 0 to 5) below which the non-urgent uploads are held, 0 : never held (default)
+void uplink_SetMinQuality(uint32_t quality);
+
+//Longest time (seconds) the oldest data of an upload can be held waiting for a better radio, 0 : until the radio improves
+void uplink_SetMaxDelay(uint32_t delaySec);
+
+//true if the radio is good enough for a non-urgent upload : a radio access technology is in use, with the min quality
+bool uplink_IsGood();
+
+//true if a non-urgent upload whose oldest data is ageSec old can go now : the radio is good, or the data waited for too long
+bool uplink_CanUpload(uint32_t ageSec);
+
+//Last signal quality read (0 to 5), -1 if unknown, without any IPC
+int32_t uplink_GetSignalQuality();
+
+#endif //_UPLINK_H_
@@ -0,0 +1,140 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file worker.c
+ *
+ * Helper lib running the slow service calls of the app (config tree commits, GNSS reads) on a worker thread:
+ *      The main thread hands a job off through a lock-free single-producer/single-consumer queue, and goes on
+ *      The completion of a job is called back on the main thread, from its event loop
+ *
+ *  The main thread only writes the head of the queue, the worker only writes its tail : a slot is published by
+ *  a release store of the head, and given back by a release store of the tail. A semaphore wakes the worker up.
+ */
+//-------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "worker.h"
+
+//max number of jobs waiting for the worker, a power of 2
+#define WORKER_QUEUE_SIZE					16
+
+typedef struct
+{
+	worker_JobFunc_t		jobPtr;
+	worker_DoneFunc_t		donePtr;
+	void*					contextPtr;
+} WorkerJob_t;
+
+static WorkerJob_t				_workerQueue[WORKER_QUEUE_SIZE];
+static uint32_t					_workerHead = 0;			//jobs submitted, written by the main thread only
+static uint32_t					_workerTail = 0;			//jobs taken, written by the worker only
+static le_sem_Ref_t				_workerSemRef = NULL;
+static le_sem_Ref_t				_workerDrainSemRef = NULL;	//posted by the last job of a drain
+static le_thread_Ref_t			_workerThreadRef = NULL;
+static le_thread_Ref_t			_mainThreadRef = NULL;
+
+
+//completion of a job, on the main thread
+static void OnJobDone(void* param1Ptr, void* param2Ptr)
+{
+	((worker_DoneFunc_t)param1Ptr)(param2Ptr);
+}
+
+//worker thread : run the queued jobs in order, report their completion to the main thread
+static void* WorkerMain(void* contextPtr)
+{
+	//services are connected per thread, the worker has its own sessions
+	le_cfg_ConnectService();
+	le_pos_ConnectService();
+
+	while (true)
+	{
+		le_sem_Wait(_workerSemRef);
+
+		uint32_t tail = __atomic_load_n(&_workerTail, __ATOMIC_RELAXED);
+
+		while (tail != __atomic_load_n(&_workerHead, __ATOMIC_ACQUIRE))
+		{
+			WorkerJob_t job = _workerQueue[tail % WORKER_QUEUE_SIZE];
+
+			//the slot can be reused by the main thread from now on
+			__atomic_store_n(&_workerTail, ++tail, __ATOMIC_RELEASE);
+
+			job.jobPtr(job.contextPtr);
+
+			if (job.donePtr)
+			{
+				le_event_QueueFunctionToThread(_mainThreadRef, OnJobDone, (void*)job.donePtr, job.contextPtr);
+			}
+		}
+	}
+
+	return NULL;
+}
+
+//Start the worker thread
+void worker_Start()
+{
+	if (_workerThreadRef)
+	{
+		return;
+	}
+
+	_mainThreadRef = le_thread_GetCurrent();
+	_workerSemRef = le_sem_Create("truckWorkerSem", 0);
+	_workerDrainSemRef = le_sem_Create("truckWorkerDrainSem", 0);
+	_workerThreadRef = le_thread_Create("truckWorker", WorkerMain, NULL);
+	le_thread_Start(_workerThreadRef);
+}
+
+//Run a job on the worker thread, or right away if it cannot be queued
+void worker_Submit(worker_JobFunc_t jobPtr, worker_DoneFunc_t donePtr, void* contextPtr)
+{
+	uint32_t head = __atomic_load_n(&_workerHead, __ATOMIC_RELAXED);
+
+	if ((NULL == _workerThreadRef) || ((head - __atomic_load_n(&_workerTail, __ATOMIC_ACQUIRE)) >= WORKER_QUEUE_SIZE))
+	{
+		LE_WARN_IF(_workerThreadRef, "Worker queue full, job run on the main thread");
+
+		jobPtr(contextPtr);
+
+		if (donePtr)
+		{
+			donePtr(contextPtr);
+		}
+
+		return;
+	}
+
+	_workerQueue[head % WORKER_QUEUE_SIZE] = (WorkerJob_t){ jobPtr, donePtr, contextPtr };
+
+	//publish the slot, then wake the worker up
+	__atomic_store_n(&_workerHead, head + 1, __ATOMIC_RELEASE);
+	le_sem_Post(_workerSemRef);
+}
+
+//last job of a drain, on the worker thread : the jobs queued before it have run
+static void OnDrained(void* contextPtr)
+{
+	le_sem_Post(_workerDrainSemRef);
+}
+
+//Wait until the jobs submitted so far have run
+le_result_t worker_Drain(uint32_t timeoutMs)
+{
+	if (NULL == _workerThreadRef)
+	{
+		return LE_OK;
+	}
+
+	//a full queue would run the drain job right away, before the queued ones
+	if ((__atomic_load_n(&_workerHead, __ATOMIC_RELAXED) - __atomic_load_n(&_workerTail, __ATOMIC_ACQUIRE)) >= WORKER_QUEUE_SIZE)
+	{
+		return LE_BUSY;
+	}
+
+	worker_Submit(OnDrained, NULL, NULL);
+
+	return le_sem_WaitWithTimeout(_workerDrainSemRef, (le_clk_Time_t){ timeoutMs / 1000, (timeoutMs % 1000) * 1000 });
+}
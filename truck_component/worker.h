@@ -0,0 +1,32 @@
+//-------------------------------------------------------------------------------------------------
+/**
+ * @file worker.h
+ *
+ * Helper lib running the slow service calls of the app (config tree commits, GNSS reads) on a worker thread:
+ *      The main thread hands a job off through a lock-free single-producer/single-consumer queue, and goes on
+ *      The completion of a job is called back on the main thread, from its event loop
+ */
+//-------------------------------------------------------------------------------------------------
+
+#ifndef _WORKER_H_
+#define _WORKER_H_
+
+//Job run on the worker thread : only services connected by the worker (le_cfg, le_pos), no app state but its context
+typedef void (* worker_JobFunc_t) (void* contextPtr);
+
+//Completion of a job, called on the main thread
+typedef void (* worker_DoneFunc_t) (void* contextPtr);
+
+
+//Start the worker thread, from the main thread : it is the only one allowed to submit jobs
+void worker_Start();
+
+//Run a job on the worker thread, donePtr (optional) is then called on the main thread with the same context
+//If the worker is not started or its queue is full, the job and its completion run right away on the calling thread
+void worker_Submit(worker_JobFunc_t jobPtr, worker_DoneFunc_t donePtr, void* contextPtr);
+
+//Wait until the jobs submitted so far have run, from the main thread : their completions are not called
+//LE_TIMEOUT if they are still running after timeoutMs, LE_BUSY if the queue is full
+le_result_t worker_Drain(uint32_t timeoutMs);
+
+#endif //_WORKER_H_